@@ -0,0 +1,4 @@
+#!/bin/bash
+gcc -Wall -Werror -O3 -march=native -mtune=native -c -o fvm_nconv.o fvm_nconv.c
+gcc -Wall -Werror -O3 -march=native -mtune=native -o test_fconv test_fconv.c \
+fvm_nconv.o -lm
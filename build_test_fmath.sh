@@ -0,0 +1,4 @@
+#!/bin/bash
+gcc -Wall -Werror -O3 -march=native -mtune=native -c -o fvm_math.o fvm_math.c
+gcc -Wall -Werror -O3 -march=native -mtune=native -o test_fmath test_fmath.c \
+fvm_math.o -lm
@@ -0,0 +1,4 @@
+#!/bin/bash
+. build_test_fvm.sh
+g++ $CCOPT $LNKOPT -o test_forthvm test_forthvm.cpp fvm_asm.o fvm_aux.o \
+fvm_math.o fvm_nconv.o fvm_library_c.o -lm
@@ -8,14 +8,29 @@ else
     LNKOPT="-s -no-pie"
 echo "release build"
 fi
+if [ "$1" == "DTC" ] || [ "$2" == "DTC" ] || [ "$3" == "DTC" ]; then
+    # direct-threaded code variant of the nucleus
+    ASMOPT="$ASMOPT -dFVM_DTC"
+    CCDEF="-DFVM_DTC"
+echo "direct-threaded code"
+else
+    CCDEF=
+fi
+if [ "$1" == "TOS" ] || [ "$2" == "TOS" ] || [ "$3" == "TOS" ]; then
+    # top of parameter stack cached in a register
+    ASMOPT="$ASMOPT -dFVM_TOS"
+echo "top-of-stack caching"
+fi
 nasm -f elf64 -w+all -w+error $ASMOPT -l fvm_asm.lst -o fvm_asm.o fvm_asm.nasm
 objdump --reloc fvm_asm.o >>fvm_asm.lst
-CCOPT="-Wall -Werror -O3 -march=native -mtune=native"
+CCOPT="-Wall -Werror -O3 -march=native -mtune=native $CCDEF"
 gcc $CCOPT -o compressf compressf.c
 ./compressf <fvm_library.f >fvm_library_comp.f
 gcc $CCOPT -o compf2src compf2src.c
 ./compf2src <fvm_library_comp.f >fvm_library_c.c
 gcc $CCOPT -c -o fvm_library_c.o fvm_library_c.c
 gcc $CCOPT -c -o fvm_aux.o fvm_aux.c
-gcc $CCOPT $LNKOPT -o test_fvm test_fvm.c fvm_asm.o fvm_aux.o fvm_library_c.o -lm
+gcc $CCOPT -c -o fvm_math.o fvm_math.c
+gcc $CCOPT -c -o fvm_nconv.o fvm_nconv.c
+gcc $CCOPT $LNKOPT -o test_fvm test_fvm.c fvm_asm.o fvm_aux.o fvm_math.o fvm_nconv.o fvm_library_c.o -lm
 nm -a test_fvm >test_fvm.lst
@@ -0,0 +1,4 @@
+#!/bin/bash
+. build_test_yulark.sh
+g++ $CCOPT $LNKOPT -pthread -o test_pool test_pool.cpp fvm_asm.o fvm_aux.o \
+fvm_math.o fvm_nconv.o fvm_library_c.o fvm_yulark_c.o -lm
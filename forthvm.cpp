@@ -24,3 +24,234 @@
 */
 
 #include "forthvm.hpp"
+
+#include <sys/mman.h>
+
+static const char* statusTexts[FVM_NUMSTATUS] = {
+    "ok",
+    "quit",
+    "parameter stack overflow",
+    "parameter stack underflow",
+    "return stack overflow",
+    "return stack underflow",
+    "dictionary space overflow",
+    "dictionary space underflow",
+    "division by zero",
+    "FPU not found",
+    "NULL pointer",
+    "unknown entity in stream",
+    "unexpected end of file",
+    "word not found",
+    "word has no parameter field",
+    "negative allot",
+    "evaluation stack overflow",
+    "invalid image",
+    "invalid signature",
+    "buffer too small",
+};
+
+ForthVM::ForthVM( size_t memSize_, size_t retStkSize_ ) {
+    forthword_t fw;
+#ifdef FVM_DTC
+    // the direct-threaded nucleus places machine code (code fields) into
+    // the dictionary space, so the memory has to be executable
+    const int prot = PROT_READ | PROT_WRITE | PROT_EXEC;
+#else
+    const int prot = PROT_READ | PROT_WRITE;
+#endif
+    void* mem = mmap( nullptr, memSize_, prot, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0 );
+    if ( mem == MAP_FAILED ) {
+        fw.zval = memSize_;
+        throw ForthVM_Exception( "failed to allocate FORTH memory", fw );
+    }
+    memory = (char*) mem;
+    memSize = memSize_;
+    retStkSize = retStkSize_;
+    context = new char [ fvm_ctxsize() ];
+    fvm_init( context, memory, memSize, retStkSize );
+    status = FVM_OK;
+}
+
+ForthVM::ForthVM( const ForthVMSnapshot& snap ) {
+    forthword_t fw;
+#ifdef FVM_DTC
+    const int prot = PROT_READ | PROT_WRITE | PROT_EXEC;
+#else
+    const int prot = PROT_READ | PROT_WRITE;
+#endif
+    void* mem = mmap( nullptr, snap.memSize, prot, MAP_PRIVATE, snap.memFd,
+        0 );
+    if ( mem == MAP_FAILED ) {
+        fw.zval = snap.memSize;
+        throw ForthVM_Exception( "failed to map FORTH snapshot", fw );
+    }
+    memory = (char*) mem;
+    memSize = snap.memSize;
+    retStkSize = snap.retStkSize;
+    context = new char [ fvm_ctxsize() ];
+    fvm_clone( context, memory, snap.context );
+    status = FVM_OK;
+}
+
+ForthVM::ForthVM( const ForthVMLayer& layer, size_t memSize_,
+    size_t retStkSize_ ) {
+    forthword_t fw;
+#ifdef FVM_DTC
+    const int prot = PROT_READ | PROT_WRITE | PROT_EXEC;
+#else
+    const int prot = PROT_READ | PROT_WRITE;
+#endif
+    void* mem = mmap( nullptr, memSize_, prot, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0 );
+    if ( mem == MAP_FAILED ) {
+        fw.zval = memSize_;
+        throw ForthVM_Exception( "failed to allocate FORTH memory", fw );
+    }
+    memory = (char*) mem;
+    memSize = memSize_;
+    retStkSize = retStkSize_;
+    context = new char [ fvm_ctxsize() ];
+    if ( !fvm_initlayer( context, memory, memSize, retStkSize,
+        layer.layer ) ) {
+        delete [] context; context = nullptr;
+        munmap( memory, memSize ); memory = nullptr;
+        fw.zval = memSize_;
+        throw ForthVM_Exception( "FORTH memory too small for layer", fw );
+    }
+    status = FVM_OK;
+}
+
+ForthVM::~ForthVM() {
+    fvm_free( context );
+    delete [] context; context = nullptr;
+    // (not if taken over by a ForthVMLayer)
+    if ( memory != nullptr ) munmap( memory, memSize );
+    memory = nullptr;
+    memSize = retStkSize = 0;
+}
+
+int ForthVM::eval( const char* src, size_t len ) {
+    status = (int) fvm_eval( context, src, len );
+    return status;
+}
+
+int ForthVM::loadLibrary() {
+    return eval( fvm_library, fvm_library_size );
+}
+
+int ForthVM::interpret() {
+    status = (int) fvm_interpret( context );
+    return status;
+}
+
+void* ForthVM::find( const char* name, size_t len ) const {
+    return fvm_find( context, name, len );
+}
+
+int ForthVM::execute( void* cfa ) {
+    status = (int) fvm_execute( context, cfa );
+    return status;
+}
+
+void ForthVM::mark() {
+    fvm_mark( context );
+}
+
+void ForthVM::forget() {
+    fvm_forget( context );
+}
+
+void ForthVM::beginLayer() {
+    fvm_layerbase( context );
+}
+
+size_t ForthVM::depth() const {
+    return (size_t) fvm_depth( context );
+}
+
+bool ForthVM::push( const forthword_t& fw ) {
+    return fvm_push( context, fw.ival ) != 0;
+}
+
+bool ForthVM::pop( forthword_t& fw ) {
+    return fvm_pop( context, &fw.ival ) != 0;
+}
+
+void ForthVM::setIO( int inFd, int outFd ) {
+    fvm_setio( context, inFd, outFd );
+}
+
+void ForthVM::setOutput( fvm_outfn_t fn, void* arg ) {
+    fvm_setout( context, fn, arg );
+}
+
+void ForthVM::setInput( fvm_infn_t fn, void* arg ) {
+    fvm_setin( context, fn, arg );
+}
+
+const char* ForthVM::statusText( int status_ ) {
+    if ( status_ < 0 || status_ >= FVM_NUMSTATUS ) return "unknown status";
+    return statusTexts[status_];
+}
+
+ForthVMSnapshot::ForthVMSnapshot( const ForthVM& vm ) {
+    forthword_t fw;
+    memFd = memfd_create( "forthvm", MFD_CLOEXEC );
+    if ( memFd < 0 || ftruncate( memFd, vm.memSize ) != 0 ) {
+        if ( memFd >= 0 ) close( memFd );
+        fw.zval = vm.memSize;
+        throw ForthVM_Exception( "failed to create FORTH snapshot", fw );
+    }
+    // only pages with data are written, the others stay holes
+    static const char zeros[4096] = { 0 };
+    for ( size_t pos = 0; pos < vm.memSize; pos += 4096U ) {
+        size_t len = vm.memSize - pos < 4096U ? vm.memSize - pos : 4096U;
+        if ( std::memcmp( vm.memory + pos, zeros, len ) == 0 ) continue;
+        if ( pwrite( memFd, vm.memory + pos, len, pos ) != (ssize_t) len ) {
+            close( memFd );
+            fw.zval = pos;
+            throw ForthVM_Exception( "failed to write FORTH snapshot", fw );
+        }
+    }
+    context = new char [ fvm_ctxsize() ];
+    std::memcpy( context, vm.context, fvm_ctxsize() );
+    memSize = vm.memSize;
+    retStkSize = vm.retStkSize;
+}
+
+ForthVMSnapshot::~ForthVMSnapshot() {
+    close( memFd ); memFd = -1;
+    delete [] context; context = nullptr;
+    memSize = retStkSize = 0;
+}
+
+ForthVMLayer::ForthVMLayer( ForthVM& vm ) {
+    forthword_t fw;
+    layer = fvm_seal( vm.context );
+    if ( layer == nullptr ) {
+        fw.zval = vm.memSize;
+        throw ForthVM_Exception( "failed to seal FORTH layer", fw );
+    }
+    fvm_free( vm.context );
+    // the layer stays where it is, at the start of the memory block: the
+    // pages it occupies become read-only, the others are released
+    memory = vm.memory;
+    vm.memory = nullptr;
+    const size_t pageSize = (size_t) sysconf( _SC_PAGESIZE );
+    mapSize = ( getSize() + pageSize - 1U ) & ~( pageSize - 1U );
+    if ( mapSize < vm.memSize ) {
+        munmap( memory + mapSize, vm.memSize - mapSize );
+    }
+#ifdef FVM_DTC
+    mprotect( memory, mapSize, PROT_READ | PROT_EXEC );
+#else
+    mprotect( memory, mapSize, PROT_READ );
+#endif
+}
+
+ForthVMLayer::~ForthVMLayer() {
+    munmap( memory, mapSize ); memory = nullptr;
+    layer = nullptr;
+    mapSize = 0;
+}
@@ -27,8 +27,8 @@
 *             Germany, Europe
 */
 
-#ifndef BUFFER_HPP
-#include "buffer.hpp"
+#ifndef TYPES_HPP
+#include "types.hpp"
 #endif
 
 class ForthVM;
@@ -62,7 +62,79 @@ public:
     }
 };
 
-extern "C" void fvm_run( void* mem, size_t siz, size_t rsz );
+// status values returned by fvm_eval() and fvm_interpret()
+// (see FVM_OK in fvm_asm.nasm)
+enum FVM_STATUS {
+    FVM_OK,             // end of input reached
+    FVM_QUIT,           // QUIT executed
+    FVM_ESTKOVF,        // parameter stack overflow
+    FVM_ESTKUNF,        // parameter stack underflow
+    FVM_ERSTKOVF,       // return stack overflow
+    FVM_ERSTKUNF,       // return stack underflow
+    FVM_EDSPCOVF,       // dictionary space overflow
+    FVM_EDSPCUNF,       // dictionary space underflow
+    FVM_EDIVZRO,        // division by zero
+    FVM_ENOFPU,         // FPU not found
+    FVM_ENULLPTR,       // NULL pointer
+    FVM_EUNKNOWN,       // unknown entity in stream
+    FVM_EUNEXPEOF,      // unexpected end of file
+    FVM_ENOTFOUND,      // word not found
+    FVM_ENOPARAM,       // word has no parameter field
+    FVM_ENEGALLOT,      // negative allot
+    FVM_EEVALSTKOVF,    // evaluation stack overflow
+    FVM_EBADIMAGE,      // invalid image
+    FVM_EBADSIG,        // invalid signature
+    FVM_EBUFSIZE,       // buffer too small
+    FVM_NUMSTATUS
+};
+
+// host output function: gets the argument, file handle, address and count
+typedef void (*fvm_outfn_t)( void* arg, int64_t fd, const char* buf,
+    size_t len );
+// host input function: gets the argument, address and size of the buffer,
+// and returns the number of bytes stored (0 at the end)
+typedef int64_t (*fvm_infn_t)( void* arg, char* buf, size_t size );
+
+// header of a dictionary layer sealed by fvm_seal()
+// (see LYR_HASHTBL in fvm_asm.nasm)
+typedef struct __fvm_layer_t {
+    void*       hashTbl;        // start of the layer (its bucket table)
+    void*       latest;         // LATEST
+    int64_t     base;           // BASE
+    void*       data;           // template of the variables
+    size_t      dataSize;       // its size in bytes
+    uint64_t*   relocs;         // bitmap of its cells to relocate
+    char*       end;            // end of the layer
+} fvm_layer_t;
+
+extern "C" {
+    void    fvm_run( void* mem, size_t siz, size_t rsz, const char* lib,
+                size_t szlib );
+    size_t  fvm_ctxsize( void );
+    void    fvm_init( void* ctx, void* mem, size_t siz, size_t rsz );
+    int64_t fvm_eval( void* ctx, const char* src, size_t len );
+    int64_t fvm_interpret( void* ctx );
+    void*   fvm_find( void* ctx, const char* name, size_t len );
+    int64_t fvm_execute( void* ctx, void* cfa );
+    void    fvm_mark( void* ctx );
+    int64_t fvm_clone( void* ctx, void* mem, const void* src );
+    void    fvm_forget( void* ctx );
+    void    fvm_layerbase( void* ctx );
+    fvm_layer_t* fvm_seal( void* ctx );
+    int64_t fvm_initlayer( void* ctx, void* mem, size_t siz, size_t rsz,
+                const fvm_layer_t* layer );
+    void    fvm_free( void* ctx );
+    int64_t fvm_depth( void* ctx );
+    int64_t fvm_push( void* ctx, int64_t cell );
+    int64_t fvm_pop( void* ctx, int64_t* pcell );
+    void    fvm_setio( void* ctx, int64_t ifd, int64_t ofd );
+    void    fvm_setout( void* ctx, fvm_outfn_t fn, void* arg );
+    void    fvm_setin( void* ctx, fvm_infn_t fn, void* arg );
+
+    // compressed library source (fvm_library_c.o)
+    extern const char fvm_library[];
+    extern size_t fvm_library_size;
+}
 
 #define FORTHVM_MEMSIZE 131072U     // 128K
 #define FVM_RETSTKSIZE  8192U       // 8K
@@ -100,10 +172,121 @@ Word definitions look like this:
 */
 
 
-class ForthVM : public Buffer {
+class ForthVMSnapshot;
+class ForthVMLayer;
+
+// A FORTH instance embedded in a C++ program. It owns its memory and the
+// context block of the nucleus. Source code is run by eval() and
+// interpret(), which return a FVM_STATUS instead of terminating; results
+// are taken from the parameter stack with pop(). Words called often are
+// better looked up once with find() and run with execute(), which doesn't
+// involve the text interpreter.
+class ForthVM {
+
+protected:
+    char*   context;
+    char*   memory;
+    size_t  memSize;
+    size_t  retStkSize;
+    int     status;
+
+public:
+    ForthVM( size_t memSize_ = FORTHVM_MEMSIZE,
+        size_t retStkSize_ = FVM_RETSTKSIZE );
+    ForthVM( const ForthVMSnapshot& snap );
+    ForthVM( const ForthVMLayer& layer, size_t memSize_ = FORTHVM_MEMSIZE,
+        size_t retStkSize_ = FVM_RETSTKSIZE );
+    ForthVM( const ForthVM& src ) = delete;
+
+    virtual ~ForthVM();
+
+    ForthVM& operator=( const ForthVM& src ) = delete;
+
+    inline char* getMemPtr() const { return memory; }
+    inline size_t getMemSize() const { return memSize; }
+    inline int getStatus() const { return status; }
+    inline bool isError() const { return status > FVM_QUIT; }
+
+    int eval( const char* src, size_t len );
+    inline int eval( const std::string& src ) {
+        return eval( src.data(), src.size() );
+    }
+    int loadLibrary();
+    int interpret();
+
+    void* find( const char* name, size_t len ) const;
+    inline void* find( const std::string& name ) const {
+        return find( name.data(), name.size() );
+    }
+    int execute( void* cfa );
+
+    void mark();
+    void forget();
+
+    void beginLayer();
+
+    size_t depth() const;
+    bool push( const forthword_t& fw );
+    bool pop( forthword_t& fw );
+
+    void setIO( int inFd, int outFd );
+    void setOutput( fvm_outfn_t fn, void* arg );
+    void setInput( fvm_infn_t fn, void* arg );
+
+    static const char* statusText( int status_ );
+
+    friend class ForthVMSnapshot;
+    friend class ForthVMLayer;
+
+};
+
+// The state of a ForthVM, e.g. after loading the libraries, from which new
+// instances are cloned cheaply. The memory block is kept in a memfd, which
+// the clones map copy-on-write, so they share the pages none of them writes
+// to. The ForthVM may be changed or destroyed afterwards.
+class ForthVMSnapshot {
+
+protected:
+    int     memFd;
+    char*   context;
+    size_t  memSize;
+    size_t  retStkSize;
 
 public:
-    // ForthVM();
+    ForthVMSnapshot( const ForthVM& vm );
+    ForthVMSnapshot( const ForthVMSnapshot& src ) = delete;
+
+    virtual ~ForthVMSnapshot();
+
+    ForthVMSnapshot& operator=( const ForthVMSnapshot& src ) = delete;
+
+    friend class ForthVM;
+
+};
+
+// The dictionary of a ForthVM, e.g. after loading the libraries, sealed to
+// be shared read-only by the instances created from it, which only hold
+// their own definitions and a copy of its variables. The ForthVM must have
+// called beginLayer() before anything was defined in it. Its memory block
+// is taken over, so it can only be destroyed afterwards.
+class ForthVMLayer {
+
+protected:
+    fvm_layer_t*    layer;
+    char*           memory;
+    size_t          mapSize;
+
+public:
+    ForthVMLayer( ForthVM& vm );
+    ForthVMLayer( const ForthVMLayer& src ) = delete;
+
+    virtual ~ForthVMLayer();
+
+    ForthVMLayer& operator=( const ForthVMLayer& src ) = delete;
+
+    inline size_t getSize() const { return (size_t)( layer->end - memory ); }
+
+    friend class ForthVM;
 
 };
 
@@ -23,6 +23,8 @@
 *             Germany, Europe
 */
 
+#define _GNU_SOURCE
+
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
@@ -30,6 +32,13 @@
 
 #include <unistd.h>
 #include <regex.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
 
 // debugging function for floating-point
 void _dbgfdot( uint64_t data ) {
@@ -157,9 +166,26 @@ static void delete_reinfo( void* rei0 ) {
     free( rei );
 }
 
+// regexec() on the len0 characters at str0 (REG_STARTEND), with nummatches
+// entries in matches; returns 0 if there's no match
+static int exec_reinfo( void* rei0, const char* str0, size_t len0,
+    size_t nummatches, regmatch_t* matches, int flags0 ) {
+    reinfo_t* rei = (reinfo_t*) rei0;
+    matches[0].rm_so = 0;
+    matches[0].rm_eo = (regoff_t) len0;
+    flags0 &= REG_NOTBOL | REG_NOTEOL;
+    int rv = regexec( &rei->regex, str0, nummatches, matches,
+        REG_STARTEND | flags0 );
+    if ( rv == REG_NOMATCH ) return 0;
+    if ( rv != 0 ) {
+        fprintf( stderr, "? Unexpected response from regexec(): %d\n", rv );
+        exit( EXIT_FAILURE );
+    }
+    return 1;
+}
+
 static void* match_reinfo( void* rei0, const char* str0, size_t len0,
     size_t numsubexpr0, int flags0 ) {
-    reinfo_t* rei = (reinfo_t*) rei0;
     size_t nummatches = 1U;
     if ( numsubexpr0 ) nummatches += numsubexpr0;
     regmatch_t* matches = (regmatch_t*) calloc( nummatches,
@@ -169,20 +195,10 @@ static void* match_reinfo( void* rei0, const char* str0, size_t len0,
             nummatches, sizeof(regmatch_t) );
         exit( EXIT_FAILURE );
     }
-    matches[0].rm_so = 0;
-    matches[0].rm_eo = (regoff_t) len0;
-    flags0 &= REG_NOTBOL | REG_NOTEOL;
-    int rv = regexec( &rei->regex, str0, nummatches, matches,
-        REG_STARTEND | flags0 );
-    if ( rv == REG_NOMATCH ) {
+    if ( !exec_reinfo( rei0, str0, len0, nummatches, matches, flags0 ) ) {
         free( matches );
         return 0;
     }
-    if ( rv != 0 ) {
-        free( matches );
-        fprintf( stderr, "? Unexpected response from regexec(): %d\n", rv );
-        exit( EXIT_FAILURE );
-    }
     uint64_t* matchesOut = (uint64_t*) calloc( nummatches * 2U,
         sizeof(uint64_t) );
     if ( matchesOut == 0 ) {
@@ -196,9 +212,38 @@ static void* match_reinfo( void* rei0, const char* str0, size_t len0,
         matchesOut[ i * 2U + 0U ] = matches[i].rm_so;
         matchesOut[ i * 2U + 1U ] = matches[i].rm_eo;
     }
+    free( matches );
     return matchesOut;
 }
 
+// like match_reinfo, but the offsets go to the nummatches pairs of cells at
+// out, and the result is nummatches (0 if there's no match). regexec()
+// writes its regmatch_t entries to the start of out, and they are widened
+// to cells in place, from the last one down. if there's no match, the first
+// pair (where the REG_STARTEND range was passed) is put back as it was.
+_Static_assert( sizeof(regmatch_t) <= 2U * sizeof(uint64_t),
+    "regmatch_t must fit into a pair of cells" );
+
+static size_t match_reinfo_into( void* rei0, const char* str0, size_t len0,
+    size_t numsubexpr0, int flags0, uint64_t* out ) {
+    size_t nummatches = 1U + numsubexpr0;
+    uint64_t first[2];
+    memcpy( first, out, sizeof(first) );
+    if ( !exec_reinfo( rei0, str0, len0, nummatches, (regmatch_t*) out,
+        flags0 ) ) {
+        memcpy( out, first, sizeof(first) );
+        return 0;
+    }
+    size_t i = nummatches;
+    while ( i-- ) {
+        regmatch_t m;
+        memcpy( &m, (char*) out + i * sizeof(regmatch_t), sizeof(m) );
+        out[ i * 2U + 0U ] = m.rm_so;
+        out[ i * 2U + 1U ] = m.rm_eo;
+    }
+    return nummatches;
+}
+
 // regular expression interface
 uint64_t _reinit( uint64_t flags0, uint64_t cpattern0 ) {
     union {
@@ -242,3 +287,407 @@ uint64_t _reexec( uint64_t rei0, uint64_t str0, uint64_t len0,
     ur.p  = res;
     return ur.ui;
 }
+
+uint64_t _rematch( uint64_t rei0, uint64_t str0, uint64_t len0,
+    uint64_t numsubexpr0, uint64_t flags0, uint64_t buf0 ) {
+    union {
+        void* p;
+        const char* s;
+        uint64_t* c;
+        uint64_t ui;
+        int i;
+        size_t z;
+    } u1, u2, u3, u4, u5, u6;
+    u1.ui = rei0;
+    u2.ui = str0;
+    u3.ui = len0;
+    u4.ui = numsubexpr0;
+    u5.ui = flags0;
+    u6.ui = buf0;
+    return match_reinfo_into( u1.p, u2.s, u3.z, u4.z, u5.i, u6.c );
+}
+
+// asynchronous I/O subroutines
+//
+// Reads and writes are queued by _aioread and _aiowrite and handed to the
+// kernel together by _aiowait, which then collects the completed ones.
+// They are done with io_uring where the kernel supports it, and otherwise
+// with epoll, where each attempt makes the descriptor non-blocking only
+// for the time of the read or write (the open file may be shared with
+// other processes, e.g. standard input and output).
+
+#define AIO_EPOLL   1U      // flag for _aioinit: don't use io_uring
+
+typedef struct _aioreq_t {
+    int      write;         // nonzero for a write
+    int      fd;
+    char*    buf;
+    size_t   len;
+    uint64_t tag;           // passed back with the result
+    uint32_t events;        // epoll: events waited for (0 if not yet tried)
+} aioreq_t;
+
+typedef struct _aioinfo_t {
+    unsigned  entries;      // number of requests that may be pending
+    unsigned  pending;      // requests queued or in progress
+    // io_uring (ring is -1 if epoll is used)
+    int       ring;
+    unsigned  queued;       // entries not yet passed to io_uring_enter
+    void*     sqmap;
+    size_t    sqmapsize;
+    void*     cqmap;
+    size_t    cqmapsize;
+    struct io_uring_sqe* sqes;
+    size_t    sqessize;
+    unsigned* sqtail;
+    unsigned* sqmask;
+    unsigned* sqarray;
+    unsigned* cqhead;
+    unsigned* cqtail;
+    unsigned* cqmask;
+    struct io_uring_cqe* cqes;
+    // epoll: the requests in order of submission
+    int       epfd;
+    aioreq_t* reqs;
+} aioinfo_t;
+
+static int setup_uring( aioinfo_t* ai ) {
+    struct io_uring_params params;
+    memset( &params, 0, sizeof(params) );
+    int ring = (int) syscall( __NR_io_uring_setup, ai->entries, &params );
+    if ( ring < 0 ) return -1;
+    // reads and writes at the current file position need this
+    if ( !( params.features & IORING_FEAT_RW_CUR_POS ) ) goto ERR1;
+    ai->sqmapsize = params.sq_off.array + params.sq_entries
+        * sizeof(unsigned);
+    ai->cqmapsize = params.cq_off.cqes + params.cq_entries
+        * sizeof(struct io_uring_cqe);
+    if ( params.features & IORING_FEAT_SINGLE_MMAP ) {
+        if ( ai->cqmapsize > ai->sqmapsize ) ai->sqmapsize = ai->cqmapsize;
+        ai->cqmapsize = 0;
+    }
+    ai->sqmap = mmap( 0, ai->sqmapsize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING );
+    if ( ai->sqmap == MAP_FAILED ) goto ERR1;
+    ai->cqmap = ai->sqmap;
+    if ( ai->cqmapsize ) {
+        ai->cqmap = mmap( 0, ai->cqmapsize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING );
+        if ( ai->cqmap == MAP_FAILED ) goto ERR2;
+    }
+    ai->sqessize = params.sq_entries * sizeof(struct io_uring_sqe);
+    ai->sqes = (struct io_uring_sqe*) mmap( 0, ai->sqessize,
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring,
+        IORING_OFF_SQES );
+    if ( ai->sqes == MAP_FAILED ) goto ERR3;
+    char* sq = (char*) ai->sqmap;
+    char* cq = (char*) ai->cqmap;
+    ai->sqtail  = (unsigned*)( sq + params.sq_off.tail );
+    ai->sqmask  = (unsigned*)( sq + params.sq_off.ring_mask );
+    ai->sqarray = (unsigned*)( sq + params.sq_off.array );
+    ai->cqhead  = (unsigned*)( cq + params.cq_off.head );
+    ai->cqtail  = (unsigned*)( cq + params.cq_off.tail );
+    ai->cqmask  = (unsigned*)( cq + params.cq_off.ring_mask );
+    ai->cqes    = (struct io_uring_cqe*)( cq + params.cq_off.cqes );
+    // the completion queue is at least as large as the submission queue
+    ai->entries = params.sq_entries;
+    ai->ring    = ring;
+    return 0;
+
+ERR3:   if ( ai->cqmapsize ) munmap( ai->cqmap, ai->cqmapsize );
+ERR2:   munmap( ai->sqmap, ai->sqmapsize );
+ERR1:   close( ring );
+        return -1;
+}
+
+static void* create_aioinfo( unsigned entries, unsigned flags ) {
+    aioinfo_t* ai = (aioinfo_t*) calloc( 1U, sizeof(aioinfo_t) );
+    if ( ai == 0 ) {
+        fprintf( stderr, "? out of memory, size = %zu\n",
+            sizeof(aioinfo_t) );
+        exit( EXIT_FAILURE );
+    }
+    if ( entries < 1U ) entries = 1U;
+    if ( entries > 4096U ) entries = 4096U;
+    ai->entries = entries;
+    ai->ring    = -1;
+    ai->epfd    = -1;
+    if ( ( flags & AIO_EPOLL ) || setup_uring( ai ) != 0 ) {
+        ai->entries = entries;
+        ai->reqs = (aioreq_t*) calloc( entries, sizeof(aioreq_t) );
+        ai->epfd = epoll_create1( EPOLL_CLOEXEC );
+        if ( ai->reqs == 0 || ai->epfd < 0 ) {
+            fprintf( stderr, "? failed to set up asynchronous I/O\n" );
+            exit( EXIT_FAILURE );
+        }
+    }
+    return (void*) ai;
+}
+
+static void delete_aioinfo( void* ai0 ) {
+    aioinfo_t* ai = (aioinfo_t*) ai0;
+    if ( ai->ring >= 0 ) {
+        munmap( ai->sqes, ai->sqessize );
+        if ( ai->cqmapsize ) munmap( ai->cqmap, ai->cqmapsize );
+        munmap( ai->sqmap, ai->sqmapsize );
+        close( ai->ring );
+    } else {
+        close( ai->epfd );
+        free( ai->reqs );
+    }
+    free( ai );
+}
+
+static int64_t queue_aioreq( void* ai0, int write, int fd, char* buf,
+    size_t len, uint64_t tag ) {
+    aioinfo_t* ai = (aioinfo_t*) ai0;
+    if ( ai->pending >= ai->entries ) return -EBUSY;
+    if ( ai->ring >= 0 ) {
+        unsigned tail = *ai->sqtail;
+        unsigned index = tail & *ai->sqmask;
+        struct io_uring_sqe* sqe = &ai->sqes[index];
+        memset( sqe, 0, sizeof(*sqe) );
+        sqe->opcode    = write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd        = fd;
+        sqe->addr      = (uint64_t)(uintptr_t) buf;
+        sqe->len       = len > 0x7ffff000U ? 0x7ffff000U : (unsigned) len;
+        sqe->off       = (uint64_t) -1;     // current position
+        sqe->user_data = tag;
+        ai->sqarray[index] = index;
+        __atomic_store_n( ai->sqtail, tail + 1U, __ATOMIC_RELEASE );
+        ++ai->queued;
+    } else {
+        if ( fcntl( fd, F_GETFL ) < 0 ) return -errno;
+        aioreq_t* req = &ai->reqs[ai->pending];
+        req->write  = write;
+        req->fd     = fd;
+        req->buf    = buf;
+        req->len    = len;
+        req->tag    = tag;
+        req->events = 0;
+    }
+    ++ai->pending;
+    return 0;
+}
+
+// collect up to max completions from io_uring, waiting for at least min
+static size_t wait_uring( aioinfo_t* ai, size_t min, uint64_t* results,
+    size_t max ) {
+    size_t n = 0;
+    for (;;) {
+        unsigned head = *ai->cqhead;
+        unsigned tail = __atomic_load_n( ai->cqtail, __ATOMIC_ACQUIRE );
+        while ( head != tail && n < max ) {
+            struct io_uring_cqe* cqe = &ai->cqes[head & *ai->cqmask];
+            results[n * 2U + 0U] = cqe->user_data;
+            results[n * 2U + 1U] = (uint64_t)(int64_t) cqe->res;
+            ++head; ++n; --ai->pending;
+        }
+        __atomic_store_n( ai->cqhead, head, __ATOMIC_RELEASE );
+        if ( n >= min && ai->queued == 0 ) return n;
+        // submit the queued requests, and wait in the same call
+        unsigned want  = n < min ? (unsigned)( min - n ) : 0U;
+        unsigned flags = want ? IORING_ENTER_GETEVENTS : 0U;
+        long rv = syscall( __NR_io_uring_enter, ai->ring, ai->queued, want,
+            flags, 0, 0 );
+        if ( rv < 0 ) {
+            if ( errno == EINTR || errno == EAGAIN || errno == EBUSY )
+                continue;
+            fprintf( stderr, "? io_uring_enter() failed: %s\n",
+                strerror( errno ) );
+            exit( EXIT_FAILURE );
+        }
+        ai->queued -= (unsigned) rv;
+    }
+}
+
+// try a request once without blocking, with the file status flags of its
+// descriptor as they were before
+static ssize_t try_aioreq( aioreq_t* req ) {
+    int fl = fcntl( req->fd, F_GETFL );
+    if ( fl < 0 ) return -errno;
+    if ( !( fl & O_NONBLOCK )
+        && fcntl( req->fd, F_SETFL, fl | O_NONBLOCK ) < 0 ) return -errno;
+    ssize_t rv = req->write ? write( req->fd, req->buf, req->len )
+                            : read( req->fd, req->buf, req->len );
+    if ( rv < 0 ) rv = -errno;
+    if ( !( fl & O_NONBLOCK ) ) fcntl( req->fd, F_SETFL, fl );
+    return rv;
+}
+
+// watch fd with epoll for the events of all requests still waiting on it
+static void watch_fd( aioinfo_t* ai, int fd ) {
+    uint32_t events = 0;
+    unsigned i;
+    for ( i=0; i < ai->pending; ++i ) {
+        if ( ai->reqs[i].fd == fd ) events |= ai->reqs[i].events;
+    }
+    if ( events == 0 ) {
+        epoll_ctl( ai->epfd, EPOLL_CTL_DEL, fd, 0 );
+        return;
+    }
+    struct epoll_event ev;
+    memset( &ev, 0, sizeof(ev) );
+    ev.events  = events;
+    ev.data.fd = fd;
+    if ( epoll_ctl( ai->epfd, EPOLL_CTL_MOD, fd, &ev ) != 0
+        && errno == ENOENT ) epoll_ctl( ai->epfd, EPOLL_CTL_ADD, fd, &ev );
+}
+
+// collect up to max completions with epoll, waiting for at least min
+static size_t wait_epoll( aioinfo_t* ai, size_t min, uint64_t* results,
+    size_t max ) {
+    size_t n = 0;
+    for (;;) {
+        // try the requests in order (those on the same descriptor must
+        // not pass each other)
+        unsigned i = 0;
+        while ( i < ai->pending && n < max ) {
+            aioreq_t* req = &ai->reqs[i];
+            unsigned j;
+            for ( j=0; j < i; ++j ) {
+                if ( ai->reqs[j].fd == req->fd
+                    && ai->reqs[j].write == req->write ) break;
+            }
+            ssize_t rv = 0;
+            if ( j == i ) rv = try_aioreq( req );
+            if ( j < i || rv == -EAGAIN || rv == -EINTR ) {
+                if ( j == i && req->events == 0 ) {
+                    req->events = req->write ? EPOLLOUT : EPOLLIN;
+                    watch_fd( ai, req->fd );
+                }
+                ++i;
+                continue;
+            }
+            results[n * 2U + 0U] = req->tag;
+            results[n * 2U + 1U] = (uint64_t) rv;
+            ++n;
+            int fd = req->fd;
+            uint32_t events = req->events;
+            --ai->pending;
+            memmove( req, req + 1, ( ai->pending - i ) * sizeof(aioreq_t) );
+            if ( events ) watch_fd( ai, fd );
+        }
+        if ( n >= min || ai->pending == 0 ) return n;
+        struct epoll_event evs[16];
+        int rv = epoll_wait( ai->epfd, evs, 16, -1 );
+        if ( rv < 0 && errno != EINTR ) {
+            fprintf( stderr, "? epoll_wait() failed: %s\n",
+                strerror( errno ) );
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+// asynchronous I/O interface
+uint64_t _aioinit( uint64_t entries0, uint64_t flags0 ) {
+    union {
+        void* p;
+        uint64_t ui;
+    } u;
+    u.ui = 0;
+    u.p  = create_aioinfo( entries0 > 4096U ? 4096U : (unsigned) entries0,
+        (unsigned) flags0 );
+    return u.ui;
+}
+
+void _aiofree( uint64_t ai0 ) {
+    union {
+        void* p;
+        uint64_t ui;
+    } u;
+    u.ui = ai0;
+    delete_aioinfo( u.p );
+}
+
+uint64_t _aioread( uint64_t ai0, uint64_t fd0, uint64_t buf0, uint64_t len0,
+    uint64_t tag0 ) {
+    union {
+        void* p;
+        char* s;
+        uint64_t ui;
+    } u1, u3;
+    u1.ui = ai0;
+    u3.ui = buf0;
+    return (uint64_t) queue_aioreq( u1.p, 0, (int) fd0, u3.s,
+        (size_t) len0, tag0 );
+}
+
+uint64_t _aiowrite( uint64_t ai0, uint64_t fd0, uint64_t buf0,
+    uint64_t len0, uint64_t tag0 ) {
+    union {
+        void* p;
+        char* s;
+        uint64_t ui;
+    } u1, u3;
+    u1.ui = ai0;
+    u3.ui = buf0;
+    return (uint64_t) queue_aioreq( u1.p, 1, (int) fd0, u3.s,
+        (size_t) len0, tag0 );
+}
+
+uint64_t _aiowait( uint64_t ai0, uint64_t min0, uint64_t results0,
+    uint64_t max0 ) {
+    union {
+        void* p;
+        uint64_t* a;
+        uint64_t ui;
+    } u1, u3;
+    u1.ui = ai0;
+    u3.ui = results0;
+    aioinfo_t* ai = (aioinfo_t*) u1.p;
+    size_t max = (size_t) max0;
+    size_t min = (size_t) min0;
+    if ( min > max ) min = max;
+    if ( min > ai->pending ) min = ai->pending;
+    if ( ai->ring >= 0 ) return wait_uring( ai, min, u3.a, max );
+    return wait_epoll( ai, min, u3.a, max );
+}
+
+// symbol lookup (for CSYM and CLIB)
+uint64_t _clib( uint64_t zname0 ) {
+    union {
+        const char* s;
+        uint64_t ui;
+    } u;
+    u.ui = zname0;
+    // the symbols of the library become visible to _csym
+    return dlopen( u.s, RTLD_NOW | RTLD_GLOBAL ) != 0 ? (uint64_t) -1 : 0;
+}
+
+uint64_t _csym( uint64_t zname0 ) {
+    union {
+        void* p;
+        const char* s;
+        uint64_t ui;
+    } u;
+    u.ui = zname0;
+    void* sym = dlsym( RTLD_DEFAULT, u.s );
+    u.ui = 0;
+    u.p  = sym;
+    return u.ui;
+}
+
+// read a dictionary image written by SAVE-IMAGE (for fvm_run_image)
+void* fvm_readimage( const char* name, size_t* psize ) {
+    FILE* fp = fopen( name, "rb" );
+    if ( fp == 0 ) {
+        fprintf( stderr, "? failed to open image '%s'\n", name );
+        return 0;
+    }
+    void* image = 0;
+    long  size  = -1L;
+    if ( fseek( fp, 0L, SEEK_END ) == 0 ) size = ftell( fp );
+    if ( size > 0L && fseek( fp, 0L, SEEK_SET ) == 0 ) {
+        image = malloc( (size_t) size );
+        if ( image == 0 ) {
+            fprintf( stderr, "? out of memory, size = %ld\n", size );
+        } else if ( fread( image, (size_t) size, 1U, fp ) != 1U ) {
+            free( image ); image = 0;
+        }
+    }
+    if ( image == 0 ) fprintf( stderr, "? failed to read image '%s'\n", name );
+    fclose( fp );
+    *psize = (size_t) size;
+    return image;
+}
@@ -29,6 +29,10 @@
 \ create a constant with a value from the stack
 : CONSTANT ( n -- ) CREATE , DOES> @ ;
 
+\ create a constant with an address from the stack, which is adjusted when
+\ the dictionary is moved (see A,)
+: ACONSTANT ( addr -- ) CREATE A, DOES> @ ;
+
 \ create an array that can hold n words
 : ARRAY ( n -- ) CREATE ALLOT ;
 
@@ -139,7 +143,7 @@ VARIABLE CSAC
         STRLIT
         \ compile string into the word with output code
         COMPILE JUMP
-        0 ,
+        0 A,
         \ HERE-8 is the address where to store the jump location
         HERE 8 -
         ( pos )
@@ -171,7 +175,7 @@ VARIABLE CSAC
         ( tgtaddr srclen )
         SWAP
         \ ( srclen tgtaddr )
-        LITERAL LITERAL
+        ALITERAL LITERAL
         \ compile TYPE
         COMPILE TYPE
     ELSE
@@ -195,7 +199,7 @@ VARIABLE CSAC
         STRLIT
         \ compile string into the word with output code
         COMPILE JUMP
-        0 ,
+        0 A,
         \ HERE-8 is the address where to store the jump location
         HERE 8 -
         ( pos )
@@ -227,7 +231,7 @@ VARIABLE CSAC
         ( tgtaddr srclen )
         SWAP
         \ ( srclen tgtaddr )
-        LITERAL LITERAL
+        ALITERAL LITERAL
     ELSE
         \ read literal into STRBUF
         STRLIT
@@ -248,7 +252,7 @@ VARIABLE CSAC
         STRLIT
         \ compile string into the word with output code
         COMPILE JUMP
-        0 ,
+        0 A,
         \ HERE-8 is the address where to store the jump location
         HERE 8 -
         ( pos )
@@ -282,7 +286,7 @@ VARIABLE CSAC
         HERE SWAP !
         \ compile string address
         ( tgtaddr )
-        LITERAL
+        ALITERAL
     ELSE
         \ read literal into STRBUF
         STRLIT
@@ -322,7 +326,7 @@ VARIABLE CSAC
         STRLIT
         \ compile string into the word with output code
         COMPILE JUMP
-        0 ,
+        0 A,
         \ HERE-8 is the address where to store the jump location
         HERE 8 -
         ( pos )
@@ -357,7 +361,7 @@ VARIABLE CSAC
         SWAP
         \ ( srclen tgtaddr )
         \ only generate code to push address, length not needed
-        LITERAL DROP
+        ALITERAL DROP
     ELSE
         \ read literal into STRBUF
         STRLIT
@@ -1677,11 +1681,23 @@ VARIABLE CSAC
     ( flags )
 ;
 
+\ re-create a regular expression object compiled by RE/ after the
+\ dictionary has been loaded from an image (see IMGHOOK)
+( addr -- )
+: RERELOAD
+    ( addr )
+    DUP 8 + @ OVER 16 +
+    ( addr flags caddr )
+    REINIT SWAP !
+;
+'CFA RERELOAD ACONSTANT RERELOAD-CFA
+
 \ quote a regular expression
-\ when compiling, create a regular expression object and put it at HERE
-\ and generate code to output it
+\ when compiling, create a regular expression object and put it at HERE,
+\ along with its flags and source for RERELOAD, and generate code to
+\ output it
 \ compiles to:
-\   LIT[regex]
+\   JUMP <pos> <hook> <regex> <flags> <str> LIT[regex-cell] @
 \
 \ ( -- addr )
 : RE/ IMMEDIATE
@@ -1689,11 +1705,32 @@ VARIABLE CSAC
         \ read regular expression literal into STRBUF
         RELIT
         ( flags )
-        \ compile the regular expression
-        STRBUF REINIT
-        ( regex )
-        \ compile regex into the word
-        LITERAL
+        \ jump over the data
+        COMPILE JUMP
+        0 A,
+        \ HERE-8 is the address where to store the jump location
+        HERE 8 -
+        ( flags pos )
+        \ re-create the regex when loading an image
+        RERELOAD-CFA IMGHOOK
+        \ compile the regular expression into a cell of its own
+        HERE 0 ,
+        ( flags pos cell )
+        ROT DUP ,
+        ( pos cell flags )
+        STRBUF REINIT OVER !
+        ( pos cell )
+        \ copy the source (counted string)
+        STRBUF HERE STRBUF C@ 1+
+        ( pos cell srcaddr tgtaddr len )
+        DUP 7 + 7 NOT AND 8 / ALLOT
+        CMOVE
+        ( pos cell )
+        \ patch the JUMP location to HERE
+        SWAP HERE SWAP !
+        ( cell )
+        \ compile code to fetch the regex
+        ALITERAL COMPILE @
     ELSE
         \ read literal into STRBUF
         RELIT
@@ -1725,8 +1762,25 @@ VARIABLE CSAC
     ( target )
 ;
 
+\ run the word stored by ONLOAD
+( addr -- )
+: ONLOAD-RUN @ RUNCODE ;
+'CFA ONLOAD-RUN ACONSTANT ONLOAD-RUN-CFA
+
+\ run a word after the dictionary has been loaded from an image
+\ (see SAVE-IMAGE), e.g. to set up variables depending on the environment
+( cfa -- )
+: ONLOAD
+    ONLOAD-RUN-CFA IMGHOOK A,
+;
+
 : BYE QUIT ;
 
-BANNER
-FREEMSG
-OKAY
+: LIB-STARTUP
+    BANNER
+    FREEMSG
+    OKAY
+;
+
+LIB-STARTUP
+'CFA LIB-STARTUP ONLOAD
@@ -0,0 +1,390 @@
+/*
+*   YULARK - a virtual machine written in C++
+*   Copyright (C) 2025  Ekkehard Morgenstern
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*   NOTE: Programs created with YULARK do not fall under this license.
+*
+*   CONTACT INFO:
+*       E-Mail: ekkehard@ekkehardmorgenstern.de
+*       Mail: Ekkehard Morgenstern, Mozartstr. 1, D-76744 Woerth am Rhein,
+*             Germany, Europe
+*/
+
+// Math kernels for the floating-point words FEXP, FLN, F**, FSIN, FCOS,
+// FTANH and their array forms.
+//
+// The kernels are branch-free double precision code built from additions,
+// multiplications, divisions, bit operations and one table lookup, so the
+// array loops are vectorized by the compiler; they are built twice, for
+// AVX2 and for the baseline instruction set, and the loader picks one.
+//
+// The error-free transformations used for F** require that a*b+c is not
+// contracted to a fused multiply-add, hence fp-contract=off; errno and the
+// floating-point exception flags are of no concern, which lets sqrt be an
+// instruction and conditional expressions be vector selects.
+//
+// Measured accuracy against glibc (see test_fmath.c): FEXP, FLN and F**
+// below 1 ulp, FSIN and FCOS below 1 ulp, FTANH below 1 ulp.
+
+#pragma GCC optimize ("fp-contract=off", "no-math-errno", "no-trapping-math")
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define TARGETS __attribute__((target_clones("avx2","default")))
+
+// array elements are processed in blocks, to decide per block whether
+// the vector kernel applies (see F** and FSIN/FCOS)
+#define BLOCKSIZE   64
+
+static inline uint64_t asuint( double d ) {
+    uint64_t u; memcpy( &u, &d, sizeof(u) ); return u;
+}
+
+static inline double asdouble( uint64_t u ) {
+    double d; memcpy( &d, &u, sizeof(d) ); return d;
+}
+
+// adding SHIFT to a value below 2^51 in magnitude leaves it rounded to an
+// integer in the low bits of the mantissa
+#define SHIFT       0x1.8p52
+
+// exp: Cody-Waite reduction x = k*ln2 + r, |r| <= ln2/2, and the rational
+// approximation of exp(r) from fdlibm (error below 2^-59)
+#define INVLN2      1.44269504088896338700e+00
+#define LN2HI       6.93147180369123816490e-01
+#define LN2LO       1.90821492927058770002e-10
+#define P1          1.66666666666666019037e-01
+#define P2         -2.77777777770155933842e-03
+#define P3          6.61375632143793436117e-05
+#define P4         -1.65339022054652515390e-06
+#define P5          4.13813679705723846039e-08
+
+// exp(x+xt), xt being a small correction (used by F**)
+static inline double k_exp( double x, double xt ) {
+    // beyond these, the result is infinity or zero anyway
+    x = x > 710.0 ? 710.0 : x;
+    x = x < -746.0 ? -746.0 : x;
+    double   t  = x * INVLN2 + SHIFT;
+    int64_t  k  = (int64_t)( asuint( t ) - asuint( SHIFT ) );
+    double   kf = t - SHIFT;
+    double   hi = x - kf * LN2HI;
+    double   lo = kf * LN2LO - xt;
+    double   r  = hi - lo;
+    double   z  = r * r;
+    double   c  = r - z * ( P1 + z * ( P2 + z * ( P3 + z * ( P4 + z * P5 ) ) ) );
+    double   y  = 1.0 - ( ( lo - ( r * c ) / ( 2.0 - c ) ) - hi );
+    // scale by 2^k in two steps, so that overflow and gradual underflow
+    // happen with a single rounding (the bias keeps the shift logical)
+    uint64_t k1 = (uint64_t)( k + 2048 ) >> 1;
+    uint64_t k2 = (uint64_t)( k + 2048 ) - k1;
+    return y * asdouble( ( k1 - 1 ) << 52 ) * asdouble( ( k2 - 1 ) << 52 );
+}
+
+// log: x = 2^e * m, m in [sqrt(1/2),sqrt(2)), m = c * (1+r) with c from a
+// table of 128 subintervals, |r| < 2^-7.4; log(x) = e*ln2 - log(1/c) +
+// log1p(r), evaluated in double-double arithmetic
+#define LOGBITS     7
+#define LOGN        (1<<LOGBITS)
+#define LOGOFF      0x3fe6a09e667f3bcdULL   // sqrt(1/2)
+#define TOPMASK     0xfff0000000000000ULL
+#define SPLIT       134217729.0             // 2^27+1
+
+// 1/c, rounded, and log(c) exactly for the rounded 1/c as high and low part
+// (separate arrays, for vector gather loads)
+static double logtab_invc[LOGN];
+static double logtab_logch[LOGN];
+static double logtab_logcl[LOGN];
+
+static void __attribute__((constructor)) init_logtab( void ) {
+    for ( int i=0; i < LOGN; ++i ) {
+        // c is the center of the subinterval
+        uint64_t cb   = LOGOFF + ( (uint64_t) i << (52-LOGBITS) ) +
+                        ( 1ULL << (51-LOGBITS) );
+        double   invc = 1.0 / asdouble( cb );
+        long double l = -logl( (long double) invc );
+        logtab_invc[i]  = invc;
+        logtab_logch[i] = (double) l;
+        logtab_logcl[i] = (double)( l - (long double) logtab_logch[i] );
+    }
+}
+
+// exact product a*b = *ph + *pl (Dekker)
+static inline void two_prod( double a, double b, double* ph, double* pl ) {
+    double p  = a * b;
+    double ta = a * SPLIT, ah = ta - ( ta - a ), al = a - ah;
+    double tb = b * SPLIT, bh = tb - ( tb - b ), bl = b - bh;
+    *ph = p;
+    *pl = ( ( ah * bh - p ) + ah * bl + al * bh ) + al * bl;
+}
+
+// exact sum a+b = *sh + *sl (Knuth)
+static inline void two_sum( double a, double b, double* sh, double* sl ) {
+    double s  = a + b;
+    double bb = s - a;
+    *sh = s;
+    *sl = ( a - ( s - bb ) ) + ( b - bb );
+}
+
+// log(x) = *lh + *ll for finite x > 0 (subnormals included)
+static inline void k_logdd( double x, double* lh, double* ll ) {
+    // subnormals are scaled into the normal range
+    int      sub = x < 0x1p-1022;
+    double   xs  = sub ? x * 0x1p54 : x;
+    uint64_t ix  = asuint( xs );
+    uint64_t tmp = ix - LOGOFF;
+    uint64_t i   = ( tmp >> (52-LOGBITS) ) % LOGN;
+    // e, sign-extended from 12 bits without arithmetic shift
+    uint64_t eb  = ( ( tmp >> 52 ) ^ 0x800 ) - 0x800;
+    double   e   = asdouble( asuint( SHIFT ) + eb ) - SHIFT - ( sub ? 54.0 : 0.0 );
+    double   m   = asdouble( ix - ( tmp & TOPMASK ) );
+    double   invc = logtab_invc[i];
+    // r = m/c - 1 exactly as rh + rl
+    double   ph, pl, rh, rl;
+    two_prod( m, invc, &ph, &pl );
+    two_sum( ph - 1.0, pl, &rh, &rl );
+    // log1p(r) - r, |r| < 2^-7.4, truncation error below 2^-68
+    double   r2 = rh * rh;
+    double   q  = r2 * ( -0.5 + rh * ( 1.0/3 + rh * ( -0.25 + rh * ( 0.2 +
+                  rh * ( -1.0/6 + rh * ( 1.0/7 + rh * -0.125 ) ) ) ) ) );
+    // sum up, largest terms exactly
+    double   s1h, s1l, s2h, s2l;
+    two_sum( e * LN2HI, logtab_logch[i], &s1h, &s1l );
+    two_sum( s1h, rh, &s2h, &s2l );
+    double   lo = s1l + s2l + ( rl - rh * rl ) + logtab_logcl[i] + e * LN2LO + q;
+    double   hi = s2h + lo;
+    *lh = hi;
+    *ll = lo - ( hi - s2h );
+}
+
+static inline double k_log( double x ) {
+    double lh, ll;
+    k_logdd( x, &lh, &ll );
+    lh = x == INFINITY ? x : lh;
+    lh = x == 0.0 ? -INFINITY : lh;
+    lh = x < 0.0 ? NAN : lh;
+    return x != x ? x : lh;
+}
+
+// x^y for finite x > 0 and finite y
+static inline double k_pow( double x, double y ) {
+    double lh, ll, zh, zl;
+    k_logdd( x, &lh, &ll );
+    two_prod( y, lh, &zh, &zl );
+    zl += y * ll;
+    // |y*log(x)| beyond the range of exp: result is infinity or zero
+    return k_exp( zh + zl, zl - ( ( zh + zl ) - zh ) );
+}
+
+static inline int pow_plain( double x, double y ) {
+    // (the product of y and log(x) is split, which must not overflow)
+    return ( x > 0.0 ) & ( x < INFINITY ) & ( fabs( y ) < 0x1p900 );
+}
+
+// sin/cos: x = k*pi/2 + r, with pi/2 in three parts of 33 bits each and
+// r as double-double, |r| <= pi/4; valid for |x| < 2^20*pi/2. The kernels
+// are those of fdlibm, each with an error below 2^-58 relative to r.
+#define TRIGMAX     1647099.0
+#define INVPIO2     6.36619772367581382433e-01
+#define PIO2_1      1.57079632673412561417e+00
+#define PIO2_2      6.07710050630396597660e-11
+#define PIO2_3      2.02226624871116645580e-21
+#define PIO2_3T     8.47842766036889956997e-32
+#define S1         -1.66666666666666324348e-01
+#define S2          8.33333333332248946124e-03
+#define S3         -1.98412698298579493134e-04
+#define S4          2.75573137070700676789e-06
+#define S5         -2.50507602534068634195e-08
+#define S6          1.58969099521155010221e-10
+#define C1          4.16666666666666019037e-02
+#define C2         -1.38888888888741095749e-03
+#define C3          2.48015872894767294178e-05
+#define C4         -2.75573143513906633035e-07
+#define C5          2.08757232129817482790e-09
+#define C6         -1.13596475577881948265e-11
+
+static inline double k_sincos( double x, int cosine ) {
+    double   t  = x * INVPIO2 + SHIFT;
+    uint64_t n  = asuint( t ) - asuint( SHIFT ) + ( cosine ? 1 : 0 );
+    double   fn = t - SHIFT;
+    // reduction in three rounds: the products are exact, the rounding
+    // errors of the differences are kept
+    double   r, e1, e2, w, y0, y1;
+    two_sum( x - fn * PIO2_1, -( fn * PIO2_2 ), &r, &e1 );
+    two_sum( r, -( fn * PIO2_3 ), &r, &e2 );
+    w  = ( e1 + e2 ) - fn * PIO2_3T;
+    y0 = r + w;
+    y1 = w - ( y0 - r );
+    // sin(y0+y1)
+    double z  = y0 * y0;
+    double v  = z * y0;
+    double sr = S2 + z * ( S3 + z * ( S4 + z * ( S5 + z * S6 ) ) );
+    double s  = y0 - ( ( z * ( 0.5 * y1 - v * sr ) - y1 ) - v * S1 );
+    // cos(y0+y1)
+    double cr = z * ( C1 + z * ( C2 + z * ( C3 + z * ( C4 + z * ( C5 + z * C6 ) ) ) ) );
+    double hz = 0.5 * z;
+    w = 1.0 - hz;
+    double c  = w + ( ( ( 1.0 - w ) - hz ) + ( z * cr - y0 * y1 ) );
+    // quadrant (cos(x) = sin(x+pi/2))
+    double res = ( n & 1 ) ? c : s;
+    res = asdouble( asuint( res ) ^ ( ( n & 2 ) << 62 ) );
+    // (the reduction loses the sign of zero)
+    return x == 0.0 && !cosine ? x : res;
+}
+
+static inline int trig_plain( double x ) {
+    return fabs( x ) < TRIGMAX;
+}
+
+// tanh(x) = em/(em+2), em = expm1(2|x|) = 2^k*(1+E) - 1 with E = expm1(r)
+// from the exp kernel; em and the division are carried in double-double,
+// as the leading terms of em cancel
+static inline double k_tanh( double x ) {
+    double   ax = fabs( x );
+    double   z  = 2.0 * ( ax > 22.0 ? 22.0 : ax );
+    double   t  = z * INVLN2 + SHIFT;
+    uint64_t k  = asuint( t ) - asuint( SHIFT );
+    double   kf = t - SHIFT;
+    double   hi = z - kf * LN2HI;
+    double   lo = kf * LN2LO;
+    double   r  = hi - lo;
+    double   rl = ( hi - r ) - lo;
+    double   zz = r * r;
+    double   c  = r - zz * ( P1 + zz * ( P2 + zz * ( P3 + zz * ( P4 + zz * P5 ) ) ) );
+    double   s  = asdouble( ( k + 1023 ) << 52 );
+    // em = (s-1) + s*r + s*(rl + r*c/(2-c)), the first sum exactly
+    double   eh, el, dh, dl, ph, pl;
+    two_sum( s - 1.0, s * r, &eh, &el );
+    el += s * ( rl + ( r * c ) / ( 2.0 - c ) );
+    t  = eh + el;
+    el = el - ( t - eh );
+    eh = t;
+    // th = em/(em+2)
+    two_sum( eh, 2.0, &dh, &dl );
+    dl += el;
+    double   q  = eh / dh;
+    two_prod( q, dh, &ph, &pl );
+    double   th = q + ( ( ( eh - ph ) - pl ) + el - q * dl ) / dh;
+    th = ax > 22.0 ? 1.0 : th;
+    th = ax != ax ? ax : th;
+    return asdouble( asuint( th ) | ( asuint( x ) & 0x8000000000000000ULL ) );
+}
+
+// scalar entry points, called from the nucleus
+
+double _fexp( double x ) {
+    return k_exp( x, 0.0 );
+}
+
+double _fln( double x ) {
+    return k_log( x );
+}
+
+double _fpow( double x, double y ) {
+    return pow_plain( x, y ) ? k_pow( x, y ) : pow( x, y );
+}
+
+double _fsin( double x ) {
+    return trig_plain( x ) ? k_sincos( x, 0 ) : sin( x );
+}
+
+double _fcos( double x ) {
+    return trig_plain( x ) ? k_sincos( x, 1 ) : cos( x );
+}
+
+double _ftanh( double x ) {
+    return k_tanh( x );
+}
+
+// array entry points: dst[i] = f(src[i]) for i in 0..n-1; dst may be the
+// same as src
+
+TARGETS void _fsqrts( const double* src, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; ++i ) dst[i] = sqrt( src[i] );
+}
+
+TARGETS void _fexps( const double* src, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; ++i ) dst[i] = k_exp( src[i], 0.0 );
+}
+
+TARGETS void _flns( const double* src, double* dst, int64_t n ) {
+    // (through a local buffer, as with F**)
+    double res[BLOCKSIZE];
+    for ( int64_t i=0; i < n; i += BLOCKSIZE ) {
+        int64_t cnt = n - i < BLOCKSIZE ? n - i : BLOCKSIZE;
+        for ( int64_t j=0; j < cnt; ++j ) res[j] = k_log( src[i+j] );
+        memcpy( dst + i, res, cnt * sizeof(double) );
+    }
+}
+
+TARGETS void _ftanhs( const double* src, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; ++i ) dst[i] = k_tanh( src[i] );
+}
+
+TARGETS static void sincos_block( const double* src, double* dst, int64_t n,
+                                  int cosine ) {
+    int plain = 1;
+    for ( int64_t i=0; i < n; ++i ) plain &= trig_plain( src[i] );
+    if ( plain ) {
+        if ( cosine ) {
+            for ( int64_t i=0; i < n; ++i ) dst[i] = k_sincos( src[i], 1 );
+        } else {
+            for ( int64_t i=0; i < n; ++i ) dst[i] = k_sincos( src[i], 0 );
+        }
+    } else {
+        for ( int64_t i=0; i < n; ++i ) {
+            dst[i] = cosine ? _fcos( src[i] ) : _fsin( src[i] );
+        }
+    }
+}
+
+void _fsins( const double* src, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; i += BLOCKSIZE ) {
+        int64_t cnt = n - i < BLOCKSIZE ? n - i : BLOCKSIZE;
+        sincos_block( src + i, dst + i, cnt, 0 );
+    }
+}
+
+void _fcoss( const double* src, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; i += BLOCKSIZE ) {
+        int64_t cnt = n - i < BLOCKSIZE ? n - i : BLOCKSIZE;
+        sincos_block( src + i, dst + i, cnt, 1 );
+    }
+}
+
+TARGETS static void pow_block( const double* xs, const double* ys,
+                               double* dst, int64_t n ) {
+    int plain = 1;
+    for ( int64_t i=0; i < n; ++i ) plain &= pow_plain( xs[i], ys[i] );
+    if ( plain ) {
+        // (the results go to a local buffer first, which cannot alias
+        // the logarithm table)
+        double res[BLOCKSIZE];
+        for ( int64_t i=0; i < n; ++i ) res[i] = k_pow( xs[i], ys[i] );
+        memcpy( dst, res, n * sizeof(double) );
+    } else {
+        for ( int64_t i=0; i < n; ++i ) dst[i] = _fpow( xs[i], ys[i] );
+    }
+}
+
+void _fpows( const double* xs, const double* ys, double* dst, int64_t n ) {
+    for ( int64_t i=0; i < n; i += BLOCKSIZE ) {
+        int64_t cnt = n - i < BLOCKSIZE ? n - i : BLOCKSIZE;
+        pow_block( xs + i, ys + i, dst + i, cnt );
+    }
+}
@@ -24,7 +24,7 @@
 \
 
 \ Create variable to hold address of YU-EXPR definition (defined later).
-\ After assignment using " 'CFA YU-EXPR YU-EXPR-CFA ! ", the variable (or
+\ After assignment using " 'CFA YU-EXPR YU-EXPR-CFA A! ", the variable (or
 \ rather, its value) can be evaluated at runtime using " YU-EXPR-CFA RUNCODE ".
 \ Thus, you cannot call a definition using the variable until its value has
 \ been defined (which should be obvious).
@@ -56,8 +56,11 @@ VARIABLE YU-TR-FILL
 1023 CONSTANT YU-TR-SIZE-UPB
 
 \ Variable indicates whether the input channel is a TTY (terminal)
+\ (checked again when the dictionary is loaded from an image)
 VARIABLE YU-IS-A-TTY
->INP @ SYSISATTY YU-IS-A-TTY !
+: YU-TTYCHECK >INP @ SYSISATTY YU-IS-A-TTY ! ;
+YU-TTYCHECK
+'CFA YU-TTYCHECK ONLOAD
 
 \ Create regular expression for whitespace
 : YU-RE-WHTSPC RE/ ^[ \t\r\n]*/ ;   \ editors might think the \ is a comment
@@ -486,26 +489,14 @@ VARIABLE YU-IS-A-TTY
     \ first, see if buffer is empty
     ?YU-TROUGH-EMPTY UNLESS
         \ nope, attempt to match whitespace
-        YU-RE-WHTSPC YU-TROUGH YU-TR-FILL @ 1 0 REEXEC
-        ( matches )
-        DUP <>0 IF
-            DUP 0 CELLS + @
-            ( matches so )
-            OVER 1 CELLS + @
-            ( matches so eo )
-            ROT
-            ( so eo matches )
-            XFREE
-            ( so eo )
-            SWAP
-            ( eo so )
-            DROP
+        YU-RE-WHTSPC YU-TROUGH YU-TR-FILL @ 1 0 REBUF REMATCH
+        ( n )
+        <>0 IF
+            \ the end offset of the match is its length
+            REBUF DROP 1 CELLS + @
             ( length )
             \ bite off that part and discard it
             YU-CHUCK
-        ELSE
-            ( 0 )
-            DROP
         THEN
     THEN
 ;
@@ -519,20 +510,12 @@ VARIABLE YU-IS-A-TTY
     YU-EAT-WHTSPC
     ( regex )
     \ attempt to match regex
-    YU-TROUGH YU-TR-FILL @ 1 0 REEXEC
-    ( matches )
+    YU-TROUGH YU-TR-FILL @ 1 0 REBUF REMATCH
+    ( n )
     DUP <>0 IF
-        DUP 0 CELLS + @
-        ( matches so )
-        OVER 1 CELLS + @
-        ( matches so eo )
-        ROT
-        ( so eo matches )
-        XFREE
-        ( so eo )
-        SWAP
-        ( eo so )
         DROP
+        \ the end offset of the match is its length
+        REBUF DROP 1 CELLS + @
         ( length )
         \ bite off that part and return it
         YU-CHOMP
@@ -640,6 +623,11 @@ VARIABLE YU-IS-A-TTY
     THEN
 ;
 
-YU-BANNER
-FREEMSG
-OKAY
+: YU-STARTUP
+    YU-BANNER
+    FREEMSG
+    OKAY
+;
+
+YU-STARTUP
+'CFA YU-STARTUP ONLOAD
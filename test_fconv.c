@@ -0,0 +1,181 @@
+/*
+*   YULARK - a virtual machine written in C++
+*   Copyright (C) 2025  Ekkehard Morgenstern
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*   NOTE: Programs created with YULARK do not fall under this license.
+*
+*   CONTACT INFO:
+*       E-Mail: ekkehard@ekkehardmorgenstern.de
+*       Mail: Ekkehard Morgenstern, Mozartstr. 1, D-76744 Woerth am Rhein,
+*             Germany, Europe
+*/
+
+// accuracy test of the number conversions in fvm_nconv.c: _ffmt10 must
+// produce the shortest text that reads back as the same number, and
+// _fparse10 must round like strtod(), on random numbers and strings
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+extern int64_t _fparse10( const char* s, int64_t len, double* pres );
+extern int64_t _ffmt10( double x, char* buf );
+
+#define COUNT   2000000
+
+static int failed = 0;
+
+static uint64_t rnd64( void ) {
+    return ( (uint64_t) random() << 62 ) ^ ( (uint64_t) random() << 31 )
+        ^ (uint64_t) random();
+}
+
+// the number of significant digits of the shortest %e form of x that
+// reads back as x
+static int shortest( double x ) {
+    char buf[64];
+    for ( int p=1; p < 17; ++p ) {
+        snprintf( buf, sizeof(buf), "%.*e", p - 1, x );
+        if ( strtod( buf, NULL ) == x ) return p;
+    }
+    return 17;
+}
+
+// the number of significant digits in the text of _ffmt10
+static int sigdigits( const char* s ) {
+    int n = 0, lead = 1, zeros = 0;
+    for ( ; *s && *s != 'E'; ++s ) {
+        if ( *s < '0' || *s > '9' ) continue;
+        if ( *s == '0' ) {
+            if ( !lead ) ++zeros;
+            continue;
+        }
+        lead = 0; n += zeros + 1; zeros = 0;
+    }
+    return n;
+}
+
+static void checkfmt( void ) {
+    int bad = 0;
+    for ( int i=0; i < COUNT; ++i ) {
+        uint64_t u = rnd64();
+        double x, y;
+        memcpy( &x, &u, sizeof(x) );
+        if ( !isnormal( x ) ) continue;
+        char buf[64];
+        int64_t len = _ffmt10( x, buf );
+        buf[len] = '\0';
+        int ok = _fparse10( buf, len, &y ) && y == x
+            && strtod( buf, NULL ) == x && sigdigits( buf ) == shortest( x );
+        if ( !ok && bad++ < 10 ) {
+            printf( "F.: %.17g printed as %s FAILED\n", x, buf );
+        }
+    }
+    printf( "F.: %d of %d wrong\n", bad, COUNT );
+    if ( bad ) failed = 1;
+}
+
+static void checkparse( void ) {
+    int bad = 0;
+    for ( int i=0; i < COUNT; ++i ) {
+        char buf[80];
+        int len = 0, nd = 1 + random() % 25;
+        if ( random() & 1 ) buf[len++] = '-';
+        for ( int j=0; j < nd; ++j ) buf[len++] = '0' + random() % 10;
+        if ( random() & 1 ) {
+            int nf = 1 + random() % 20;
+            buf[len++] = '.';
+            for ( int j=0; j < nf; ++j ) buf[len++] = '0' + random() % 10;
+        }
+        if ( random() & 1 ) {
+            len += sprintf( buf + len, "e%d", (int)( random() % 700 ) - 350 );
+        }
+        buf[len] = '\0';
+        double x = 0.0, ref = strtod( buf, NULL );
+        if ( ( !_fparse10( buf, len, &x ) || memcmp( &x, &ref, sizeof(x) ) )
+             && bad++ < 10 ) {
+            printf( "?MATCHNUM: %s read as %.17g FAILED\n", buf, x );
+        }
+    }
+    printf( "?MATCHNUM: %d of %d wrong\n", bad, COUNT );
+    if ( bad ) failed = 1;
+}
+
+static void checktext( const char* text, const char* expected ) {
+    double x;
+    char buf[64];
+    if ( !_fparse10( text, strlen( text ), &x ) ) {
+        printf( "%s: not a number FAILED\n", text );
+        failed = 1;
+        return;
+    }
+    buf[_ffmt10( x, buf )] = '\0';
+    if ( strcmp( buf, expected ) ) {
+        printf( "%s: got %s, expected %s FAILED\n", text, buf, expected );
+        failed = 1;
+    }
+}
+
+static void checkinvalid( const char* text ) {
+    double x;
+    if ( _fparse10( text, strlen( text ), &x ) ) {
+        printf( "%s: read as a number FAILED\n", text );
+        failed = 1;
+    }
+}
+
+int main( int argc, char** argv ) {
+    srandom( 4711 );
+
+    checkfmt();
+    checkparse();
+
+    // the output format, and the special values
+    checktext( "0.1", "0.1" );
+    checktext( "-0.5", "-0.5" );
+    checktext( "-0.0", "-0" );
+    checktext( "1e15", "1000000000000000" );
+    checktext( "1e16", "1E16" );
+    checktext( "1.5e-15", "0.0000000000000015" );
+    checktext( "1e-16", "1E-16" );
+    checktext( "12.5E-1", "1.25" );
+    checktext( "1'3", "1000" );
+    checktext( "+2.5e+2", "250" );
+    checktext( "0.30000000000000004", "0.30000000000000004" );
+    checktext( "1.7976931348623157e308", "1.7976931348623157E308" );
+    checktext( "1.8e308", "inf" );
+    checktext( "4.9e-324", "den" );
+    checktext( "2e-324", "0" );
+    checktext( "9007199254740993", "9007199254740992" );
+    checktext( "123456789012345678901234567890", "1.2345678901234568E29" );
+    checkinvalid( "" );
+    checkinvalid( "-" );
+    checkinvalid( ".5" );
+    checkinvalid( "5." );
+    checkinvalid( "1e" );
+    checkinvalid( "1e+" );
+    checkinvalid( "1.5x" );
+    checkinvalid( "1e5.5" );
+
+    if ( failed ) {
+        printf( "FAILED\n" );
+        return EXIT_FAILURE;
+    }
+    printf( "all passed\n" );
+    return EXIT_SUCCESS;
+}
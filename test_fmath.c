@@ -0,0 +1,191 @@
+/*
+*   YULARK - a virtual machine written in C++
+*   Copyright (C) 2025  Ekkehard Morgenstern
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*   NOTE: Programs created with YULARK do not fall under this license.
+*
+*   CONTACT INFO:
+*       E-Mail: ekkehard@ekkehardmorgenstern.de
+*       Mail: Ekkehard Morgenstern, Mozartstr. 1, D-76744 Woerth am Rhein,
+*             Germany, Europe
+*/
+
+// accuracy test of the math kernels in fvm_math.c: the scalar and array
+// entry points are compared against the long double functions of libm,
+// on random arguments and on special values
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <float.h>
+
+extern double _fexp( double x );
+extern double _fln( double x );
+extern double _fpow( double x, double y );
+extern double _fsin( double x );
+extern double _fcos( double x );
+extern double _ftanh( double x );
+extern void _fsqrts( const double* src, double* dst, int64_t n );
+extern void _fexps( const double* src, double* dst, int64_t n );
+extern void _flns( const double* src, double* dst, int64_t n );
+extern void _fsins( const double* src, double* dst, int64_t n );
+extern void _fcoss( const double* src, double* dst, int64_t n );
+extern void _ftanhs( const double* src, double* dst, int64_t n );
+extern void _fpows( const double* xs, const double* ys, double* dst,
+    int64_t n );
+
+#define COUNT   200000
+
+static double xs[COUNT], ys[COUNT], res[COUNT];
+static int    failed = 0;
+
+// error of res in units of the last place of the exact value ref
+static double ulperr( double res, long double ref ) {
+    if ( isnan( ref ) ) return isnan( res ) ? 0.0 : INFINITY;
+    if ( isinf( ref ) || fabsl( ref ) > DBL_MAX ) {
+        return res == (double) ref ? 0.0 : INFINITY;
+    }
+    int e; frexpl( ref, &e );
+    // ulp of a double at the magnitude of ref (subnormals: the smallest)
+    long double ulp = ldexpl( 1.0L, ( e < -1021 ? -1021 : e ) - 53 );
+    return (double)( fabsl( (long double) res - ref ) / ulp );
+}
+
+static double rnd( double lo, double hi ) {
+    return lo + ( hi - lo ) * ( (double) random() / RAND_MAX );
+}
+
+typedef double (*func1_t)( double );
+typedef void (*array1_t)( const double*, double*, int64_t );
+typedef long double (*ref1_t)( long double );
+
+static void check1( const char* name, func1_t f, array1_t af, ref1_t ref,
+    double lo, double hi, double maxulp ) {
+    for ( int i=0; i < COUNT; ++i ) xs[i] = rnd( lo, hi );
+    af( xs, res, COUNT );
+    double worst = 0.0, worstx = 0.0;
+    for ( int i=0; i < COUNT; ++i ) {
+        long double r = ref( xs[i] );
+        double e1 = ulperr( f( xs[i] ), r );
+        double e2 = ulperr( res[i], r );
+        if ( e1 > worst ) { worst = e1; worstx = xs[i]; }
+        if ( e2 > worst ) { worst = e2; worstx = xs[i]; }
+    }
+    int ok = worst <= maxulp;
+    printf( "%-6s [%g,%g]: max error %.3f ulp at %.17g%s\n", name, lo, hi,
+        worst, worstx, ok ? "" : " FAILED" );
+    if ( !ok ) failed = 1;
+}
+
+static void checkpow( double xlo, double xhi, double ylo, double yhi,
+    double maxulp ) {
+    for ( int i=0; i < COUNT; ++i ) {
+        xs[i] = rnd( xlo, xhi ); ys[i] = rnd( ylo, yhi );
+    }
+    _fpows( xs, ys, res, COUNT );
+    double worst = 0.0, worstx = 0.0, worsty = 0.0;
+    for ( int i=0; i < COUNT; ++i ) {
+        long double r = powl( xs[i], ys[i] );
+        double e1 = ulperr( _fpow( xs[i], ys[i] ), r );
+        double e2 = ulperr( res[i], r );
+        if ( e2 > e1 ) e1 = e2;
+        if ( e1 > worst ) { worst = e1; worstx = xs[i]; worsty = ys[i]; }
+    }
+    int ok = worst <= maxulp;
+    printf( "F**    [%g,%g]^[%g,%g]: max error %.3f ulp at %.17g^%.17g%s\n",
+        xlo, xhi, ylo, yhi, worst, worstx, worsty, ok ? "" : " FAILED" );
+    if ( !ok ) failed = 1;
+}
+
+static void checkspecial( const char* name, double res, double expected ) {
+    if ( ( isnan( expected ) && isnan( res ) ) ||
+         ( res == expected && signbit( res ) == signbit( expected ) ) ) {
+        return;
+    }
+    printf( "%s: got %.17g, expected %.17g FAILED\n", name, res, expected );
+    failed = 1;
+}
+
+static double sqrtd( double x ) { return sqrt( x ); }
+
+int main( int argc, char** argv ) {
+    srandom( 4711 );
+
+    check1( "FSQRT", sqrtd, _fsqrts, sqrtl, 0.0, 1e300, 0.5 );
+    check1( "FEXP", _fexp, _fexps, expl, -1.0, 1.0, 1.0 );
+    check1( "FEXP", _fexp, _fexps, expl, -745.0, 709.7, 1.0 );
+    check1( "FLN", _fln, _flns, logl, 0.5, 2.0, 1.0 );
+    check1( "FLN", _fln, _flns, logl, 0.0, 1e300, 1.0 );
+    check1( "FLN", _fln, _flns, logl, 0.0, 1e-300, 1.0 );
+    check1( "FSIN", _fsin, _fsins, sinl, -4.0, 4.0, 1.0 );
+    check1( "FSIN", _fsin, _fsins, sinl, -1e6, 1e6, 1.0 );
+    check1( "FCOS", _fcos, _fcoss, cosl, -4.0, 4.0, 1.0 );
+    check1( "FCOS", _fcos, _fcoss, cosl, -1e6, 1e6, 1.0 );
+    check1( "FTANH", _ftanh, _ftanhs, tanhl, -1.0, 1.0, 1.0 );
+    check1( "FTANH", _ftanh, _ftanhs, tanhl, -25.0, 25.0, 1.0 );
+    checkpow( 0.0, 10.0, -10.0, 10.0, 1.0 );
+    checkpow( 0.0, 2.0, -1000.0, 1000.0, 1.0 );
+    checkpow( 0.9, 1.1, -7000.0, 7000.0, 1.0 );
+
+    // special values, as in the C library
+    double inf = INFINITY, nan = NAN;
+    checkspecial( "FEXP(inf)", _fexp( inf ), inf );
+    checkspecial( "FEXP(-inf)", _fexp( -inf ), 0.0 );
+    checkspecial( "FEXP(nan)", _fexp( nan ), nan );
+    checkspecial( "FEXP(1000)", _fexp( 1000.0 ), inf );
+    checkspecial( "FEXP(-1000)", _fexp( -1000.0 ), 0.0 );
+    checkspecial( "FEXP(-740)", _fexp( -740.0 ), exp( -740.0 ) );
+    checkspecial( "FLN(0)", _fln( 0.0 ), -inf );
+    checkspecial( "FLN(-1)", _fln( -1.0 ), nan );
+    checkspecial( "FLN(inf)", _fln( inf ), inf );
+    checkspecial( "FLN(1)", _fln( 1.0 ), 0.0 );
+    checkspecial( "FLN(min)", _fln( 0x1p-1074 ), log( 0x1p-1074 ) );
+    checkspecial( "F**(-2,3)", _fpow( -2.0, 3.0 ), -8.0 );
+    checkspecial( "F**(0,0)", _fpow( 0.0, 0.0 ), 1.0 );
+    checkspecial( "F**(2,1e300)", _fpow( 2.0, 1e300 ), inf );
+    checkspecial( "F**(1,nan)", _fpow( 1.0, nan ), 1.0 );
+    checkspecial( "F**(nan,0)", _fpow( nan, 0.0 ), 1.0 );
+    checkspecial( "F**(1e-300,-2)", _fpow( 1e-300, -2.0 ), inf );
+    checkspecial( "FSIN(-0)", _fsin( -0.0 ), -0.0 );
+    checkspecial( "FSIN(inf)", _fsin( inf ), nan );
+    checkspecial( "FSIN(1e22)", _fsin( 1e22 ), sin( 1e22 ) );
+    checkspecial( "FCOS(0)", _fcos( 0.0 ), 1.0 );
+    checkspecial( "FTANH(-0)", _ftanh( -0.0 ), -0.0 );
+    checkspecial( "FTANH(inf)", _ftanh( inf ), 1.0 );
+    checkspecial( "FTANH(-30)", _ftanh( -30.0 ), -1.0 );
+
+    // in-place operation, and lengths that are no multiple of the vector
+    // or block size
+    for ( int i=0; i < 131; ++i ) xs[i] = i * 0.25 - 3.0;
+    xs[77] = 1e20;
+    memcpy( ys, xs, 131 * sizeof(double) );
+    _fsins( ys, ys, 131 );
+    for ( int i=0; i < 131; ++i ) {
+        checkspecial( "FSINS in place", ys[i], _fsin( xs[i] ) );
+    }
+    ys[0] = 42.0;
+    _fexps( xs, ys, 0 );
+    checkspecial( "FEXPS of nothing", ys[0], 42.0 );
+
+    if ( failed ) {
+        printf( "FAILED\n" );
+        return EXIT_FAILURE;
+    }
+    printf( "all passed\n" );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/*
+*   YULARK - a virtual machine written in C++
+*   Copyright (C) 2025  Ekkehard Morgenstern
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*   NOTE: Programs created with YULARK do not fall under this license.
+*
+*   CONTACT INFO:
+*       E-Mail: ekkehard@ekkehardmorgenstern.de
+*       Mail: Ekkehard Morgenstern, Mozartstr. 1, D-76744 Woerth am Rhein,
+*             Germany, Europe
+*/
+
+#include "forthvm.cpp"
+
+#include <exception>
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#define MEMSIZE     1048576U
+#define RSTKSIZE    65536U
+
+static void collect( void* arg, int64_t fd, const char* buf, size_t len ) {
+    if ( fd == 1 ) ((std::string*) arg)->append( buf, len );
+}
+
+static int64_t feed( void* arg, char* buf, size_t size ) {
+    std::string* src = (std::string*) arg;
+    size_t len = src->size() < size ? src->size() : size;
+    std::memcpy( buf, src->data(), len );
+    src->erase( 0, len );
+    return (int64_t) len;
+}
+
+// for CFUNC: more arguments than registers, of both kinds
+static double mixargs( int64_t i1, double d1, int64_t i2, int64_t i3,
+    int64_t i4, int64_t i5, int64_t i6, int64_t i7, double d2, double d3,
+    double d4, double d5, double d6, double d7, double d8, int64_t i8,
+    double d9, double d10 ) {
+    return i1 + 2*i2 + 3*i3 + 4*i4 + 5*i5 + 6*i6 + 7*i7 + 8*i8
+        + 100.0 * ( d1 + 2*d2 + 3*d3 + 4*d4 + 5*d5 + 6*d6 + 7*d7 + 8*d8
+        + 9*d9 + 10*d10 );
+}
+
+static int failures = 0;
+
+static void check( bool cond, const char* what ) {
+    std::cout << ( cond ? "ok    " : "FAIL  " ) << what << std::endl;
+    if ( !cond ) ++failures;
+}
+
+int main( int argc, char** argv ) {
+
+    try {
+        std::string out1, out2;
+        ForthVM vm1( MEMSIZE, RSTKSIZE );
+        ForthVM vm2( MEMSIZE, RSTKSIZE );
+        vm1.setOutput( collect, &out1 );
+        vm2.setOutput( collect, &out2 );
+        check( vm1.loadLibrary() == FVM_OK, "load library 1" );
+        check( vm2.loadLibrary() == FVM_OK, "load library 2" );
+        out1.clear(); out2.clear();
+
+        check( vm1.eval( "1 2 + ." ) == FVM_OK && out1 == "3 ", "output" );
+        check( vm1.eval( "3 4 *" ) == FVM_OK && vm1.depth() == 1,
+            "result on stack" );
+        forthword_t fw;
+        check( vm1.pop( fw ) && fw.ival == 12 && vm1.depth() == 0, "pop" );
+        check( !vm1.pop( fw ), "pop from empty stack" );
+
+        fw.ival = 40; vm1.push( fw );
+        fw.ival = 2; vm1.push( fw );
+        check( vm1.eval( "+" ) == FVM_OK && vm1.pop( fw ) && fw.ival == 42,
+            "push arguments" );
+
+        check( vm1.eval( ": SQ DUP * ; 7" ) == FVM_OK, "define word" );
+        check( vm1.eval( "SQ" ) == FVM_OK && vm1.pop( fw ) && fw.ival == 49,
+            "word defined in previous call" );
+        check( vm2.eval( "SQ" ) != FVM_OK && vm2.depth() == 0,
+            "instances are separate" );
+
+        void* sq = vm1.find( "SQ" );
+        fw.ival = 9; vm1.push( fw );
+        check( sq != nullptr && vm1.execute( sq ) == FVM_OK
+            && vm1.pop( fw ) && fw.ival == 81, "find and execute" );
+        void* plus = vm1.find( "+" );
+        int64_t sum = 0;
+        for ( int64_t i = 1; i <= 1000; ++i ) {
+            fw.ival = sum; vm1.push( fw );
+            fw.ival = i; vm1.push( fw );
+            vm1.execute( plus );
+            vm1.pop( fw ); sum = fw.ival;
+        }
+        check( sum == 500500, "execute primitive repeatedly" );
+        check( vm1.find( "NOSUCHWORD" ) == nullptr, "find unknown word" );
+        check( vm1.execute( vm1.find( "DROP" ) ) == FVM_ESTKUNF,
+            "execute with stack underflow" );
+        check( vm1.eval( "1 2 DROP DROP DROP" ) == FVM_ESTKUNF,
+            "stack underflow" );
+        check( vm1.depth() == 0, "stack empty after error" );
+        check( vm1.eval( ": BROKEN 1 2" ) == FVM_OK
+            && vm1.eval( "NOSUCHWORD" ) > FVM_QUIT, "unknown word" );
+        check( vm1.eval( "1 0 /" ) == FVM_EDIVZRO,
+            "immediate mode after error" );
+        out1.clear();
+        check( vm1.eval( "5 SQ ." ) == FVM_OK && out1 == "25 ",
+            "continue after error" );
+        check( vm1.eval( "1 QUIT 2" ) == FVM_QUIT && vm1.depth() == 1,
+            "QUIT" );
+        vm2.mark();
+        check( vm2.eval( ": SQ 0 ; VARIABLE V 16 BASE !" ) == FVM_OK
+            && vm2.find( "V" ) != nullptr, "define after mark" );
+        vm2.forget();
+        check( vm2.find( "V" ) == nullptr && vm2.find( "SQ" ) == nullptr
+            && vm2.find( "DUP" ) != nullptr, "forget" );
+        out2.clear();
+        check( vm2.eval( ": SQ DUP * ; 10 SQ ." ) == FVM_OK && out2 == "100 ",
+            "define again after forget" );
+        // JIT code space allocated after the mark starts over as well
+        vm2.mark();
+        vm2.eval( ": JQ DUP + ; 'CFA JQ JIT DROP" );
+        vm2.forget();
+        out2.clear();
+        check( vm2.eval( ": JQ DUP + ; 'CFA JQ JIT . 5 JQ ." ) == FVM_OK
+            && out2 == "-1 10 ", "JIT after forget" );
+
+        // clones start out with the state of the snapshot
+        vm1.eval( ": CUBE DUP SQ * ; VARIABLE CNT 5 CNT ! 99" );
+        std::string out3;
+        {
+            ForthVMSnapshot snap( vm1 );
+            vm1.eval( "CUBE 0 CNT !" );
+            ForthVM vm3( snap );
+            vm3.setOutput( collect, &out3 );
+            check( vm3.depth() == 2 && vm3.eval( "DROP 3 CUBE . CNT @ ." )
+                == FVM_OK && out3 == "27 5 ", "clone" );
+            check( vm1.eval( "CNT @" ) == FVM_OK && vm1.pop( fw )
+                && fw.ival == 0, "clone is separate" );
+        }
+        check( vm1.eval( "DROP DROP" ) == FVM_OK, "source still works" );
+
+        // only addresses compiled by A, A! and ALITERAL move along
+        vm1.eval( "CREATE AB 0 , VARIABLE AP AB AP A! VARIABLE AD AB AD ! "
+            ": ALX IMMEDIATE AB ALITERAL ; : AL ALX ;" );
+        {
+            ForthVMSnapshot snap( vm1 );
+            ForthVM vm3( snap );
+            vm3.setOutput( collect, &out3 );
+            out3.clear();
+            check( vm3.eval( "AP @ AB = . AL AB = . AD @ AB = ." ) == FVM_OK
+                && out3 == "-1 -1 0 ", "clone relocation map" );
+        }
+
+        // no tail calls into words that take frames off the return stack,
+        // also not in the words they call
+        out1.clear();
+        check( vm1.eval( ": TB R> R> DROP >R ; : TA 1 TB ; : TC 5 TA ; "
+            ": TD TC 3 ; : TE TD 4 ; TE . . . ." ) == FVM_OK
+            && out1 == "4 3 1 5 ", "tail call keeps frames" );
+        out1.clear();
+        check( vm1.eval( ": TB2 R> R> SWAP >R >R ; : TA2 TB2 ; : TC2 7 TA2 ; "
+            ": TD2 TC2 8 ; : TE2 TD2 9 ; TE2 . . ." ) == FVM_OK
+            && out1 == "9 8 7 ", "tail call keeps swapped frames" );
+
+        // tasks take turns at PAUSE, each with its own stacks
+        out1.clear();
+        check( vm1.eval( ": TW 3 BEGIN 84 EMIT PAUSE 1- DUP =0 UNTIL ; "
+            "32 TASK CONSTANT TK 'CFA TW TK START "
+            ": TM 4 BEGIN 46 EMIT PAUSE 1- DUP =0 UNTIL DROP ; TM" ) == FVM_OK
+            && out1 == ".T.T.T." && vm1.depth() == 0, "tasks" );
+        check( vm1.eval( ": TB 1 0 / ; 'CFA TB TK START 7 PAUSE" )
+            == FVM_EDIVZRO && vm1.depth() == 0, "error in task" );
+        out1.clear();
+        check( vm1.eval( "PAUSE 8 DUP . MYTASK TK <> ." ) == FVM_OK
+            && out1 == "8 -1 " && vm1.depth() == 1 && vm1.pop( fw )
+            && fw.ival == 8, "back in task of host" );
+        vm1.mark();
+        vm1.eval( "16 TASK CONSTANT TK2 'CFA TW TK2 START" );
+        vm1.forget();
+        out1.clear();
+        check( vm1.eval( "'CFA TW TK START PAUSE PAUSE" ) == FVM_OK
+            && out1 == "TT", "forget task" );
+
+        // asynchronous I/O on a pipe, with io_uring (if possible) and epoll
+        vm1.eval( "VARIABLE AIO CREATE ARES 32 ALLOT CREATE ABUF 16 ALLOT "
+            ": AIOT ( rfd wfd flags -- ) 4 SWAP AIONEW AIO ! "
+            "SWAP AIO @ SWAP ABUF 16 1 AIOREAD SWAP AIO @ SWAP S\" ping\" "
+            "2 AIOWRITE + . AIO @ 2 ARES 4 AIOWAIT . ABUF 4 TYPE "
+            "ARES 8 + @ ARES 24 + @ + . AIO @ AIOFREE ;" );
+        for ( int64_t flags = 0; flags <= 1; ++flags ) {
+            int fds[2];
+            check( pipe( fds ) == 0, "pipe" );
+            fw.ival = fds[0]; vm1.push( fw );
+            fw.ival = fds[1]; vm1.push( fw );
+            fw.ival = flags; vm1.push( fw );
+            out1.clear();
+            check( vm1.eval( "AIOT" ) == FVM_OK && out1 == "0 2 ping8 ",
+                flags ? "asynchronous I/O with epoll" : "asynchronous I/O" );
+            // the descriptors are left blocking
+            check( !( fcntl( fds[0], F_GETFL ) & O_NONBLOCK )
+                && !( fcntl( fds[1], F_GETFL ) & O_NONBLOCK ),
+                "asynchronous I/O file status flags" );
+            close( fds[0] ); close( fds[1] );
+        }
+
+        // TYPE with a negative count writes nothing
+        out1.clear();
+        check( vm1.eval( "S\" ab\" TYPE S\" cd\" DROP -1 TYPE 7 ." )
+            == FVM_OK && out1 == "ab7 ", "TYPE negative count" );
+
+        // C functions with double arguments and result
+        fw.ptr = (void*) mixargs; vm1.push( fw );
+        check( vm1.eval( "S\" idiiiiiidddddddidd:d\" CFUNC MIX "
+            ": MIXT 1 1.0 2 3 4 5 6 7 2.0 3.0 4.0 5.0 6.0 7.0 8.0 8 9.0 "
+            "10.0 MIX ; MIXT" ) == FVM_OK && vm1.pop( fw )
+            && fw.dval == 38704.0 && vm1.depth() == 0, "CFUNC" );
+        fw.ptr = (void*) mixargs; vm1.push( fw );
+        check( vm1.eval( "S\" id:\" CFUNC MIX2" ) == FVM_EBADSIG
+            && vm1.find( "MIX2" ) == nullptr, "CFUNC with invalid signature" );
+        out1.clear();
+        check( vm1.eval( "Z\" libm.so.6\" CLIB Z\" sqrt\" CSYM S\" d:d\" "
+            "CFUNC CSQRT 2.25 CSQRT F." ) == FVM_OK && out1 == "1.5 ",
+            "CFUNC of libm" );
+
+        // block memory words
+        out1.clear();
+        check( vm1.eval( "CREATE MB 200 ALLOT : MBT MB 200 46 FILL "
+            "S\" 0123456789\" MB SWAP CMOVE MB MB 3 + 7 CMOVE MB 12 TYPE "
+            "MB 100 + 20 97 FILL MB 100 + MB 90 + 100 CMOVE "
+            "MB 120 + 10 ERASE MB 90 + 20 TYPE MB 130 + C@ . MB 129 + C@ . ;"
+            " MBT" ) == FVM_OK
+            && out1 == "0120123456..aaaaaaaaaaaaaaaaaaaa46 0 ",
+            "block memory words" );
+        out1.clear();
+        check( vm1.eval( ": CMPT S\" abc\" S\" abd\" COMPARE . "
+            "S\" abc\" S\" abc\" COMPARE . S\" abc\" S\" ab\" COMPARE . "
+            "S\" ab\" S\" abc\" COMPARE . S\" \" S\" \" COMPARE . ; CMPT" )
+            == FVM_OK && out1 == "-1 0 1 -1 0 ", "COMPARE" );
+
+        // words in lower case, separated by all kinds of space characters,
+        // of the longest length, and at the end of the input
+        out1.clear();
+        check( vm1.eval( "\t: tkt\r\n  2\t3 +\n. ;  tkt s\" ab\" type "
+            ": TOKENIZERTOKENIZERTOKENIZERTOK 7 ; "
+            "tokenizertokenizertokenizertok . 1 2 + ." ) == FVM_OK
+            && out1 == "5 ab7 3 ", "tokenizer" );
+
+        // a name of 31 characters is read whole, a longer one is split
+        // after 31, both within the input and at its end
+        out1.clear();
+        check( vm1.eval( ": ABCDEFGHIJKLMNOPQRSTUVWXYZABCDE 11 ; : FG 22 ; "
+            "abcdefghijklmnopqrstuvwxyzabcde . "
+            "abcdefghijklmnopqrstuvwxyzabcdefg . . "
+            "abcdefghijklmnopqrstuvwxyzabcdefg" ) == FVM_OK
+            && vm1.eval( ". ." ) == FVM_OK && out1 == "11 22 11 22 11 ",
+            "tokenizer name length" );
+
+        // number conversion: integers in several bases, and shortest
+        // round-trip floating-point numbers in base 10
+        out1.clear();
+        check( vm1.eval( "-1234567 . 18446744073709551615 U. HEX -1A . "
+            "FFFFFFFFFFFF U. DECIMAL 2 BASE ! 101010 . DECIMAL" ) == FVM_OK
+            && out1 == "-1234567 18446744073709551615 -1A FFFFFFFFFFFF "
+            "101010 ", "integer conversion" );
+        out1.clear();
+        check( vm1.eval( "-0.5 F. 0.1 0.2 F+ F. 1e20 F. 1.5e-20 F. "
+            "12345678901234567890123.0 F. 0.000123 F. 1'3 F." )
+            == FVM_OK && out1 == "-0.5 0.30000000000000004 1E20 1.5E-20 "
+            "1.2345678901234568E22 0.000123 1000 ", "float conversion" );
+        check( vm1.eval( "2.2250738585072011e-308 4.9e-324" ) == FVM_OK
+            && vm1.pop( fw ) && fw.dval == 4.9e-324 && vm1.pop( fw )
+            && fw.dval == 2.2250738585072011e-308, "float rounding" );
+
+        // regular expression match into REBUF, which is left as it was
+        // (in the first pair) if there's no match
+        out1.clear();
+        check( vm1.eval( "RE/ ([a-z]+)([0-9]*)/ CONSTANT RXR "
+            ": RXT RXR ROT ROT 2 0 REBUF REMATCH . ; "
+            ": RXB REBUF DROP DUP @ . DUP 8 + @ . DUP 16 + @ . 40 + @ . ; "
+            "S\" ab12 x\" RXT RXB 7 REBUF DROP ! 9 REBUF DROP 8 + ! "
+            "S\" 99\" RXT REBUF DROP @ . REBUF DROP 8 + @ . REBUF . DROP" )
+            == FVM_OK && out1 == "3 0 4 0 4 0 7 9 10 ", "regex match" );
+        check( vm1.eval( "RXR S\" ab\" 10 0 REBUF REMATCH" ) == FVM_EBUFSIZE,
+            "regex match buffer size" );
+
+        // math words, and their array forms
+        out1.clear();
+        check( vm1.eval( "2.25 FSQRT F. 0.0 FEXP F. 1.0 FLN F. 0.0 FSIN F. "
+            "0.0 FCOS F. 0.0 FTANH F. -2.0 3.0 F** F." ) == FVM_OK
+            && out1 == "1.5 1 0 0 1 0 -8 ", "math words" );
+        check( vm1.eval( "2.0 0.5 F** 1.0 FEXP 3.0 FTANH" ) == FVM_OK
+            && vm1.pop( fw ) && std::fabs( fw.dval - std::tanh( 3.0 ) )
+            < 1e-15 && vm1.pop( fw ) && std::fabs( fw.dval - std::exp( 1.0 ) )
+            < 1e-15 && vm1.pop( fw ) && std::fabs( fw.dval - std::sqrt( 2.0 ) )
+            < 1e-15, "math words accuracy" );
+        check( vm1.eval( "CREATE FA 5 CELLS ALLOT CREATE FB 5 CELLS ALLOT "
+            ": FAT 0.5 FA ! 1.0 FA 8 + ! 1.5 FA 16 + ! 2.0 FA 24 + ! "
+            "2.5 FA 32 + ! FA FB 5 FEXPS FB FB 5 FLNS FA FB FB 5 F**S "
+            "FB 32 + @ ; FAT" ) == FVM_OK && vm1.pop( fw )
+            && std::fabs( fw.dval - std::pow( 2.5, 2.5 ) ) < 1e-14,
+            "math array words" );
+
+        // instances on a shared layer get their own copy of its variables
+        {
+            std::string out4, out5;
+            ForthVM base( MEMSIZE, RSTKSIZE );
+            base.setOutput( collect, &out4 );
+            base.beginLayer();
+            check( base.loadLibrary() == FVM_OK && base.eval(
+                "VARIABLE TALLY 7 TALLY ! : TICK TALLY @ 1+ TALLY ! ;" )
+                == FVM_OK, "build layer" );
+            ForthVMLayer layer( base );
+            ForthVM vm4( layer );
+            ForthVM vm5( layer );
+            vm4.setOutput( collect, &out4 );
+            vm5.setOutput( collect, &out5 );
+            out4.clear();
+            check( vm4.eval( "TICK TICK TALLY @ ." ) == FVM_OK
+                && out4 == "9 ", "variable of layer" );
+            check( vm5.eval( "TALLY @ . 3 ' TALLY ! : SETT TALLY ! ; TALLY @ ."
+                " 4 SETT TICK TALLY @ ." ) == FVM_OK && out5 == "7 3 5 ",
+                "own copy of variable" );
+            out4.clear(); out5.clear();
+            check( vm5.eval( ": TICK 0 TALLY ! ; TICK TALLY @ ." ) == FVM_OK
+                && out5 == "0 " && vm4.eval( "TICK TALLY @ ." ) == FVM_OK
+                && out4 == "10 ", "definition hides one of layer" );
+            out4.clear();
+            check( vm4.eval( ": HI .\" hi\" ; HI" ) == FVM_OK
+                && out4 == "hi", "library words using variables" );
+            check( vm4.eval( "HIDE" ) == FVM_OK, "hide" );
+            check( vm4.find( "HI" ) == nullptr, "hide own word" );
+            ForthVM vm6( layer );
+            check( vm6.eval( "HIDE" ) == FVM_OK
+                && vm6.find( "TICK" ) == nullptr
+                && vm4.find( "TICK" ) != nullptr, "hide word of layer" );
+            check( vm6.eval( "UNHIDE UNHIDE" ) == FVM_OK
+                && vm6.find( "TICK" ) != nullptr, "unhide word of layer" );
+            check( vm6.eval( "HERE" ) == FVM_OK && vm6.pop( fw )
+                && fw.ptr >= vm6.getMemPtr()
+                && fw.ptr < vm6.getMemPtr() + 16384, "small instance" );
+            {
+                ForthVMSnapshot snap( vm4 );
+                ForthVM vm7( snap );
+                out4.clear();
+                vm7.setOutput( collect, &out4 );
+                check( vm7.eval( "TICK TALLY @ ." ) == FVM_OK
+                    && out4 == "11 ", "clone instance on layer" );
+            }
+        }
+
+        std::string in2( "6 7 * .\n: TWICE 2 * ;\n21 TWICE ." );
+        vm2.setInput( feed, &in2 );
+        out2.clear();
+        check( vm2.interpret() == FVM_OK && out2 == "42 42 ",
+            "interpret input from host" );
+
+        // SAVE-IMAGE writes to its file, not to the host output function
+        const char* imgName = "/tmp/test_forthvm.img";
+        out2.clear();
+        struct stat st;
+        check( vm2.eval( "S\" /tmp/test_forthvm.img\" SAVE-IMAGE" ) == FVM_OK
+            && vm2.pop( fw ) && fw.ival == -1 && out2.empty()
+            && stat( imgName, &st ) == 0 && st.st_size > 4096,
+            "save image with host output" );
+        unlink( imgName );
+
+        // a new input file with the handle number of the previous one
+        {
+            const char* srcName = "/tmp/test_forthvm.f";
+            std::string out3;
+            ForthVM vm3( MEMSIZE, RSTKSIZE );
+            vm3.setOutput( collect, &out3 );
+            const char* texts[] = { "1 2 + .\n", "3 4 * .\n" };
+            bool ok = true;
+            for ( const char* text : texts ) {
+                FILE* f = std::fopen( srcName, "w" );
+                std::fputs( text, f );
+                std::fclose( f );
+                int fd = open( srcName, O_RDONLY );
+                vm3.setIO( fd, 1 );
+                ok = ok && vm3.interpret() == FVM_OK;
+                close( fd );
+            }
+            unlink( srcName );
+            check( ok && out3 == "3 12 ", "interpret reopened input file" );
+        }
+
+        check( std::string( ForthVM::statusText( FVM_EDIVZRO ) )
+            == "division by zero", "status text" );
+    } catch ( const std::exception& xcpt ) {
+        std::cerr << "exception: " << xcpt.what() << std::endl;
+        return EXIT_FAILURE;
+    } catch ( ... ) {
+        std::cerr << "unhandled exception" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/*
+*   YULARK - a virtual machine written in C++
+*   Copyright (C) 2025  Ekkehard Morgenstern
+*
+*   This program is free software: you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation, either version 3 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*
+*   NOTE: Programs created with YULARK do not fall under this license.
+*
+*   CONTACT INFO:
+*       E-Mail: ekkehard@ekkehardmorgenstern.de
+*       Mail: Ekkehard Morgenstern, Mozartstr. 1, D-76744 Woerth am Rhein,
+*             Germany, Europe
+*/
+
+// runs many FORTH jobs (source files or strings) in parallel, on a pool of
+// worker threads with one FORTH instance each. the instances load the
+// libraries once (or share them, see -s); the words a job defines are
+// forgotten after it.
+//
+// usage: test_pool [-j threads] [-y] [-s] [-q] [-l listfile] [-e source]
+//                  [file]...
+//   -j    number of worker threads (default: number of CPUs)
+//   -y    load the YULARK library as well
+//   -s    load the libraries once into a layer shared by the instances
+//   -q    don't print the output of the jobs, just the report
+//   -l    read file names from listfile, one per line ("-" for STDIN)
+//   -e    add a job for a source string
+
+#include "forthvm.cpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+extern "C" const char fvm_yulark[];
+extern "C" size_t fvm_yulark_size;
+
+#define MEMSIZE     1048576U
+#define RSTKSIZE    65536U
+
+typedef std::chrono::steady_clock Clock;
+
+struct Job {
+    std::string name;       // file name, or empty for a source string
+    std::string source;
+    std::string out;        // output to STDOUT
+    std::string err;        // output to STDERR (error messages)
+    int         status = FVM_OK;
+    double      usec = 0;
+};
+
+struct Pool {
+    std::vector<Job>    jobs;
+    std::atomic<size_t> next;
+    bool                yulark;
+    ForthVMLayer*       layer;      // shared libraries (or nullptr)
+    std::atomic<int>    failures;
+};
+
+static void collect( void* arg, int64_t fd, const char* buf, size_t len ) {
+    Job* job = (Job*) arg;
+    if ( fd == 2 ) job->err.append( buf, len );
+    else job->out.append( buf, len );
+}
+
+static void discard( void* arg, int64_t fd, const char* buf, size_t len ) {
+    if ( fd == 2 ) std::cerr.write( buf, len );
+}
+
+static bool readFile( const std::string& name, std::string& text ) {
+    std::ifstream file( name, std::ios::in | std::ios::binary );
+    if ( !file ) return false;
+    std::ostringstream data;
+    data << file.rdbuf();
+    text = data.str();
+    return true;
+}
+
+static bool loadLibraries( ForthVM& vm, bool yulark ) {
+    vm.setOutput( discard, nullptr );
+    if ( vm.loadLibrary() != FVM_OK
+      || ( yulark && vm.eval( fvm_yulark, fvm_yulark_size ) != FVM_OK ) ) {
+        std::cerr << "failed to load libraries: "
+            << ForthVM::statusText( vm.getStatus() ) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void worker( Pool* pool ) {
+    try {
+        std::unique_ptr<ForthVM> vmp( pool->layer
+            ? new ForthVM( *pool->layer, MEMSIZE, RSTKSIZE )
+            : new ForthVM( MEMSIZE, RSTKSIZE ) );
+        ForthVM& vm = *vmp;
+        vm.setOutput( discard, nullptr );
+        if ( !pool->layer && !loadLibraries( vm, pool->yulark ) ) {
+            ++pool->failures;
+            return;
+        }
+        vm.mark();
+        size_t n;
+        while ( ( n = pool->next++ ) < pool->jobs.size() ) {
+            Job& job = pool->jobs[n];
+            Clock::time_point t0 = Clock::now();
+            if ( !job.name.empty() && !readFile( job.name, job.source ) ) {
+                job.err = "? cannot read " + job.name + "\n";
+                job.status = FVM_EUNEXPEOF;
+            } else {
+                vm.setOutput( collect, &job );
+                job.status = vm.eval( job.source );
+                vm.forget();
+                job.source.clear();
+            }
+            job.usec = std::chrono::duration<double, std::micro>(
+                Clock::now() - t0 ).count();
+        }
+    } catch ( const std::exception& xcpt ) {
+        std::cerr << "exception: " << xcpt.what() << std::endl;
+        ++pool->failures;
+    }
+}
+
+int main( int argc, char** argv ) {
+
+    Pool pool;
+    pool.next = 0;
+    pool.yulark = false;
+    pool.layer = nullptr;
+    pool.failures = 0;
+    unsigned threads = std::thread::hardware_concurrency();
+    bool quiet = false;
+    bool shared = false;
+
+    for ( int i = 1; i < argc; ++i ) {
+        std::string arg( argv[i] );
+        Job job;
+        if ( arg == "-y" ) {
+            pool.yulark = true;
+        } else if ( arg == "-s" ) {
+            shared = true;
+        } else if ( arg == "-q" ) {
+            quiet = true;
+        } else if ( arg == "-j" && i + 1 < argc ) {
+            threads = (unsigned) std::strtoul( argv[++i], nullptr, 10 );
+        } else if ( arg == "-e" && i + 1 < argc ) {
+            job.source = argv[++i];
+            pool.jobs.push_back( job );
+        } else if ( arg == "-l" && i + 1 < argc ) {
+            std::string listName( argv[++i] );
+            std::ifstream listFile;
+            if ( listName != "-" ) {
+                listFile.open( listName );
+                if ( !listFile ) {
+                    std::cerr << "cannot read " << listName << std::endl;
+                    return EXIT_FAILURE;
+                }
+            }
+            std::istream& list = listName == "-" ? std::cin : listFile;
+            while ( std::getline( list, job.name ) ) {
+                if ( !job.name.empty() ) pool.jobs.push_back( job );
+            }
+        } else if ( arg[0] == '-' ) {
+            std::cerr << "Usage: " << argv[0] << " [-j threads] [-y] [-s] "
+                "[-q] [-l listfile] [-e source] [file]..." << std::endl;
+            return EXIT_FAILURE;
+        } else {
+            job.name = arg;
+            pool.jobs.push_back( job );
+        }
+    }
+    if ( threads == 0 ) threads = 1;
+    if ( threads > pool.jobs.size() && !pool.jobs.empty() ) {
+        threads = (unsigned) pool.jobs.size();
+    }
+
+    Clock::time_point t0 = Clock::now();
+    std::unique_ptr<ForthVMLayer> layer;
+    if ( shared ) {
+        try {
+            ForthVM base( MEMSIZE, RSTKSIZE );
+            base.beginLayer();
+            if ( !loadLibraries( base, pool.yulark ) ) return EXIT_FAILURE;
+            layer.reset( new ForthVMLayer( base ) );
+            pool.layer = layer.get();
+        } catch ( const std::exception& xcpt ) {
+            std::cerr << "exception: " << xcpt.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::vector<std::thread> workers;
+    for ( unsigned i = 0; i < threads; ++i ) {
+        workers.emplace_back( worker, &pool );
+    }
+    for ( std::thread& t : workers ) t.join();
+    double secs = std::chrono::duration<double>( Clock::now() - t0 ).count();
+
+    // output of the jobs in their order, then the report
+    int errors = 0;
+    for ( size_t n = 0; n < pool.jobs.size(); ++n ) {
+        const Job& job = pool.jobs[n];
+        if ( !quiet ) {
+            std::cout << job.out;
+            std::cerr << job.err;
+        }
+        if ( job.status > FVM_QUIT ) ++errors;
+    }
+    std::cout.flush();
+    for ( size_t n = 0; n < pool.jobs.size(); ++n ) {
+        const Job& job = pool.jobs[n];
+        std::fprintf( stderr, "# %6zu %10.1f us  %-28s %s\n", n + 1, job.usec,
+            ForthVM::statusText( job.status ),
+            job.name.empty() ? "(-e)" : job.name.c_str() );
+    }
+    std::fprintf( stderr, "# %zu jobs, %u threads, %.3f s, %.0f jobs/s, "
+        "%d errors\n", pool.jobs.size(), threads, secs,
+        secs > 0 ? pool.jobs.size() / secs : 0.0, errors );
+
+    return errors || pool.failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -30,6 +30,9 @@
 #include <stdio.h>
 
 #include <unistd.h>
+#ifdef FVM_DTC
+#include <sys/mman.h>
+#endif
 #include <regex.h>
 
 extern const char fvm_library[];
@@ -40,14 +43,39 @@ extern size_t fvm_yulark_size;
 
 extern void fvm_run( void* mem, size_t siz, size_t rsz,
     const char* lib, size_t szlib );
+extern void fvm_run_image( void* mem, size_t siz, size_t rsz,
+    const void* img, size_t szimg );
+extern void* fvm_readimage( const char* name, size_t* psize );
 
 #define MEMSIZE     1048576U
 #define RSTKSIZE    65536U
 
+#ifndef FVM_DTC
 static char memory[MEMSIZE];
+#endif
 
 int main( int argc, char** argv ) {
 
+#ifdef FVM_DTC
+    // the direct-threaded nucleus places machine code (code fields) into
+    // the dictionary space, so the memory has to be executable
+    char* memory = (char*) mmap( 0, MEMSIZE,
+        PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS,
+        -1, 0 );
+    if ( memory == MAP_FAILED ) return EXIT_FAILURE;
+#endif
+
+    // -i <file> loads a dictionary written by SAVE-IMAGE instead of
+    // compiling the libraries
+    if ( argc == 3 && strcmp( argv[1], "-i" ) == 0 ) {
+        size_t size;
+        void* image = fvm_readimage( argv[2], &size );
+        if ( image == 0 ) return EXIT_FAILURE;
+        fvm_run_image( memory, MEMSIZE, RSTKSIZE, image, size );
+        free( image );
+        return EXIT_SUCCESS;
+    }
+
     size_t size = fvm_library_size + fvm_yulark_size;
     char* libs = (char*) malloc( size );
     if ( libs == 0 ) return EXIT_FAILURE;